@@ -0,0 +1,561 @@
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE // syscall()
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#define CARGS_IMPLEMENTATION
+#include "cargs.h"
+
+// Measures the cost per argv token of cargs_parse() against a schema of N flags.
+// Run it with different schema sizes to check that the per-token cost stays flat:
+//   gcc -O2 -pthread bench.c -o bench
+//   ./bench 128 && ./bench 16384
+// With a second argument it also runs independent cargs_ctx parsers on 1..T threads
+// and reports the combined throughput, which should scale with the number of cores:
+//   ./bench 128 8
+// It also prints the bytes per flag record and, where perf events are available, the cache misses per token.
+// Finally it compares the integer and double converters behind cargs_parse() with strtoll() and strtod(),
+// and the getopt shim with the C library's getopt_long() on --flagN=value tokens.
+//
+// The suite mode runs a fixed grid of synthetic schemas (8 to 100k flags, 1 to 1M tokens, mixed types, heavy
+// positional use, long shared-prefix names) and writes ns/token, allocations and peak RSS per case to a
+// tab-separated file. On Linux each case runs in a child process, so the RSS is the peak of that case alone.
+// The compare mode does the same and flags cases that got slower or bigger than a stored baseline: more
+// allocations at all, or ns/token or peak RSS up by more than the threshold:
+//   ./bench --suite [bench_output.txt]
+//   mv bench_output.txt bench_baseline.txt    # after a run worth keeping
+//   ./bench --compare bench_baseline.txt [threshold_percent, default 10]
+
+#define BENCH_TOKENS 100000
+#define BENCH_ROUNDS 20
+#define BENCH_LINE_TOKENS 64
+#define BENCH_LINES_PER_THREAD 20000
+#define BENCH_NUMBERS 1000000
+#define BENCH_GETOPT_TOKENS 10000
+
+static int nflags;
+static char (*names)[24];
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Opens a counter of hardware cache events for this thread, or returns -1 where there are none (other systems,
+// virtual machines without a PMU, perf_event_paranoid > 2). The counter starts right away.
+static int bench_counter_open(uint32_t type, uint64_t config)
+{
+#ifdef __linux__
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#else
+    (void)type;
+    (void)config;
+    return -1;
+#endif
+}
+
+static long long bench_counter(int fd)
+{
+    long long n = 0;
+#ifdef __linux__
+    if (fd >= 0 && read(fd, &n, sizeof(n)) != (ssize_t)sizeof(n)) n = 0;
+#else
+    (void)fd;
+#endif
+    return n;
+}
+
+// fills argv with alternating flag/value pairs spread over the whole schema
+static int bench_argv(char **argv, int tokens, unsigned seed)
+{
+    argv[0] = "bench";
+    for (int i = 1; i + 1 <= tokens; i += 2) {
+        argv[i]     = names[((unsigned)i * 2654435761u + seed) % (unsigned)nflags];
+        argv[i + 1] = "42";
+    }
+    return 1 + (tokens / 2) * 2;
+}
+
+// parses many short command lines with a private context, like a worker in a job dispatcher
+static void *bench_worker(void *arg)
+{
+    unsigned seed = (unsigned)(size_t)arg;
+    char *argv[1 + BENCH_LINE_TOKENS];
+    cargs_ctx ctx;
+    cargs_ctx_init(&ctx);
+
+    for (int line = 0; line < BENCH_LINES_PER_THREAD; ++line) {
+        int argc = bench_argv(argv, BENCH_LINE_TOKENS, seed + (unsigned)line);
+        cargs_ctx_reset(&ctx);
+        for (int i = 0; i < nflags; ++i) {
+            cargs_ctx_int(&ctx, names[i], "benchmark flag", 0);
+        }
+        if (!cargs_ctx_parse(&ctx, argc, argv)) {
+            cargs_ctx_log_error(&ctx, stderr);
+            exit(1);
+        }
+    }
+
+    cargs_ctx_free(&ctx);
+    return NULL;
+}
+
+// Suite mode: synthetic schemas and argv lists over a grid of sizes, written as one line per case.
+
+#define BENCH_LONG_NAME 240
+
+enum bench_shape { BENCH_MIXED, BENCH_POSITIONAL, BENCH_LONG_NAMES };
+static const char *const bench_shape_names[] = { "mixed", "positional", "long-names" };
+
+struct bench_case {
+    enum bench_shape shape;
+    int flags;  // registered flags, positionals included
+    int tokens; // argv entries after the program name
+};
+
+struct bench_result {
+    double ns_per_token; // best round
+    size_t allocs;       // allocations of the first round, registration included
+    long peak_rss_kb;    // peak of the child process that ran the case, or of this process without fork()
+};
+
+static size_t bench_allocs;
+
+// counts every allocation the library makes, then defers to realloc/free
+static void *bench_counting_alloc(void *user, void *ptr, size_t old_size, size_t new_size)
+{
+    (void)user;
+    (void)old_size;
+    if (new_size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    bench_allocs++;
+    return realloc(ptr, new_size);
+}
+
+// Flag i of a case: mixed cases cycle through int, double, string, bool and uint64 flags; positional cases
+// register only positionals; long-name cases use names that share a 240 character prefix, so every lookup
+// hashes and compares the whole name, and interleave long words that match nothing and land in positionals.
+static void bench_register(cargs_ctx *ctx, const struct bench_case *c, char **names_, int positionals)
+{
+    for (int i = 0; i < c->flags - positionals; ++i) {
+        switch (c->shape == BENCH_MIXED ? i % 5 : 0) {
+            case 0: cargs_ctx_int(ctx, names_[i], "int flag", 0); break;
+            case 1: cargs_ctx_double(ctx, names_[i], "double flag", 0.0); break;
+            case 2: cargs_ctx_string(ctx, names_[i], "string flag", ""); break;
+            case 3: cargs_ctx_bool(ctx, names_[i], "bool flag", false); break;
+            default: cargs_ctx_uint64(ctx, names_[i], "uint64 flag", 0); break;
+        }
+    }
+    for (int i = c->flags - positionals; i < c->flags; ++i) {
+        cargs_ctx_positional(ctx, names_[i], "positional", false);
+    }
+}
+
+static struct bench_result bench_run(const struct bench_case *c)
+{
+    static const char *const values[] = { "42", "2.5", "abc", NULL, "0x2a" };
+    char **names_ = malloc((size_t)c->flags * sizeof(*names_));
+    char **argv = malloc((size_t)(c->tokens + 2) * sizeof(*argv));
+    char *long_word = malloc(BENCH_LONG_NAME + 16);
+    memset(long_word, 'w', BENCH_LONG_NAME);
+    long_word[BENCH_LONG_NAME] = '\0';
+
+    // positional slots for every positional token the argv below produces
+    int positionals = c->shape == BENCH_POSITIONAL ? c->flags : c->shape == BENCH_LONG_NAMES ? c->tokens / 8 + 1 : 0;
+    if (positionals > c->flags - 1 && c->shape == BENCH_LONG_NAMES) positionals = c->flags - 1;
+    for (int i = 0; i < c->flags; ++i) {
+        names_[i] = malloc(BENCH_LONG_NAME + 16);
+        if (i >= c->flags - positionals) snprintf(names_[i], BENCH_LONG_NAME + 16, "pos%d", i);
+        else if (c->shape == BENCH_LONG_NAMES) snprintf(names_[i], BENCH_LONG_NAME + 16, "--%s%d", long_word + 2, i);
+        else snprintf(names_[i], BENCH_LONG_NAME + 16, "--flag%d", i);
+    }
+
+    argv[0] = "bench";
+    int argc = 1, used_positionals = 0, regular = c->flags - positionals;
+    for (unsigned k = 0; argc <= c->tokens; ++k) {
+        unsigned i = (k * 2654435761u) % (unsigned)(regular > 0 ? regular : 1);
+        if (c->shape == BENCH_POSITIONAL || (c->shape == BENCH_LONG_NAMES && k % 4 == 3 && used_positionals < positionals)) {
+            argv[argc++] = c->shape == BENCH_POSITIONAL ? "file.txt" : long_word;
+            used_positionals++;
+            if (c->shape == BENCH_POSITIONAL && used_positionals == positionals) break;
+            continue;
+        }
+        const char *value = c->shape == BENCH_MIXED ? values[i % 5] : "42";
+        if (value != NULL && argc + 1 > c->tokens) {
+            // one slot left: a bool flag fills it if the schema has one
+            if (c->shape != BENCH_MIXED || i - i % 5 + 3 >= (unsigned)regular) break;
+            i = i - i % 5 + 3;
+            value = NULL;
+        }
+        argv[argc++] = names_[i];
+        if (value != NULL) argv[argc++] = (char *)value;
+    }
+    argv[argc] = NULL;
+
+    int rounds = 2000000 / (c->tokens > c->flags ? c->tokens : c->flags);
+    if (rounds < 3) rounds = 3;
+    if (rounds > 1000) rounds = 1000;
+
+    struct bench_result res = { 1e300, 0, 0 };
+    cargs_ctx ctx;
+    cargs_ctx_init(&ctx);
+    cargs_ctx_set_allocator(&ctx, bench_counting_alloc, NULL);
+    for (int round = 0; round < rounds; ++round) {
+        size_t allocs = bench_allocs;
+        cargs_ctx_reset(&ctx);
+        bench_register(&ctx, c, names_, positionals);
+        double t0 = bench_now();
+        if (!cargs_ctx_parse(&ctx, argc, argv)) {
+            cargs_ctx_log_error(&ctx, stderr);
+            exit(1);
+        }
+        double ns = (bench_now() - t0) / (argc - 1 > 0 ? argc - 1 : 1);
+        if (ns < res.ns_per_token) res.ns_per_token = ns;
+        if (round == 0) res.allocs = bench_allocs - allocs;
+    }
+    cargs_ctx_free(&ctx);
+
+    for (int i = 0; i < c->flags; ++i) free(names_[i]);
+    free(names_);
+    free(argv);
+    free(long_word);
+    return res;
+}
+
+// Runs a case in a forked child, which sends its result back through a pipe, and takes the peak RSS from the
+// child's resource usage; a case that fails or crashes is fatal. Without fork() it runs in this process, and the
+// peak is the process peak so far, which is only meaningful for the largest case.
+static struct bench_result bench_run_isolated(const struct bench_case *c)
+{
+    struct bench_result res;
+#ifdef __linux__
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        res = bench_run(c);
+        _exit(write(fds[1], &res, sizeof(res)) == (ssize_t)sizeof(res) ? 0 : 1);
+    }
+    close(fds[1]);
+    ssize_t got = read(fds[0], &res, sizeof(res));
+    close(fds[0]);
+    int status;
+    struct rusage usage;
+    if (wait4(pid, &status, 0, &usage) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0 ||
+        got != (ssize_t)sizeof(res)) {
+        fprintf(stderr, "case %s/%d/%d failed\n", bench_shape_names[c->shape], c->flags, c->tokens);
+        exit(1);
+    }
+    res.peak_rss_kb = usage.ru_maxrss;
+#else
+    res = bench_run(c);
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    res.peak_rss_kb = usage.ru_maxrss;
+#endif
+    return res;
+}
+
+// Runs every case and writes "shape flags tokens ns_per_token allocs peak_rss_kb" lines to out_path. With a
+// baseline in the same format, cases that allocate more, or got slower or use more memory by more than threshold
+// percent, are reported, and the exit status is 1 if there were any.
+static int bench_suite(const char *out_path, const char *baseline_path, double threshold)
+{
+    static const int mixed_flags[] = { 8, 64, 512, 4096, 32768, 100000 };
+    static const int mixed_tokens[] = { 1, 100, 10000, 1000000 };
+    static const int positional_flags[] = { 8, 512, 32768, 100000 };
+    static const int long_flags[] = { 8, 4096, 100000 };
+    static const int long_tokens[] = { 10000, 1000000 };
+
+    struct bench_case cases[64];
+    int ncases = 0;
+    for (size_t f = 0; f < sizeof(mixed_flags) / sizeof(mixed_flags[0]); ++f)
+        for (size_t t = 0; t < sizeof(mixed_tokens) / sizeof(mixed_tokens[0]); ++t)
+            cases[ncases++] = (struct bench_case){ BENCH_MIXED, mixed_flags[f], mixed_tokens[t] };
+    for (size_t f = 0; f < sizeof(positional_flags) / sizeof(positional_flags[0]); ++f)
+        cases[ncases++] = (struct bench_case){ BENCH_POSITIONAL, positional_flags[f], positional_flags[f] };
+    for (size_t f = 0; f < sizeof(long_flags) / sizeof(long_flags[0]); ++f)
+        for (size_t t = 0; t < sizeof(long_tokens) / sizeof(long_tokens[0]); ++t)
+            cases[ncases++] = (struct bench_case){ BENCH_LONG_NAMES, long_flags[f], long_tokens[t] };
+
+    FILE *baseline = baseline_path != NULL ? fopen(baseline_path, "r") : NULL;
+    if (baseline_path != NULL && baseline == NULL) {
+        fprintf(stderr, "cannot read baseline %s\n", baseline_path);
+        return 1;
+    }
+    FILE *out = fopen(out_path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "cannot write %s\n", out_path);
+        return 1;
+    }
+    fprintf(out, "# shape\tflags\ttokens\tns_per_token\tallocs\tpeak_rss_kb\n");
+    printf("%-11s %7s %8s %12s %8s %12s\n", "shape", "flags", "tokens", "ns/token", "allocs", "peak_rss_kb");
+
+    int regressions = 0;
+    for (int i = 0; i < ncases; ++i) {
+        const struct bench_case *c = &cases[i];
+        struct bench_result r = bench_run_isolated(c);
+        fprintf(out, "%s\t%d\t%d\t%.3f\t%zu\t%ld\n", bench_shape_names[c->shape], c->flags, c->tokens, r.ns_per_token, r.allocs, r.peak_rss_kb);
+        fflush(out);
+        printf("%-11s %7d %8d %12.2f %8zu %12ld", bench_shape_names[c->shape], c->flags, c->tokens, r.ns_per_token, r.allocs, r.peak_rss_kb);
+
+        // the baseline is scanned for the matching line; it holds a few dozen lines at most
+        char line[256], shape[32];
+        int flags, tokens;
+        double ns;
+        struct bench_result base = { -1, 0, 0 };
+        if (baseline != NULL) rewind(baseline);
+        while (baseline != NULL && fgets(line, sizeof(line), baseline) != NULL) {
+            if (sscanf(line, "%31s %d %d %lf %zu %ld", shape, &flags, &tokens, &ns, &base.allocs, &base.peak_rss_kb) == 6 &&
+                strcmp(shape, bench_shape_names[c->shape]) == 0 && flags == c->flags && tokens == c->tokens) {
+                base.ns_per_token = ns;
+                break;
+            }
+        }
+        if (base.ns_per_token > 0) {
+            // allocation counts are exact, so any increase counts; time and RSS get the threshold for noise
+            double change = (r.ns_per_token - base.ns_per_token) / base.ns_per_token * 100.0;
+            double rss_change = base.peak_rss_kb > 0 ? (double)(r.peak_rss_kb - base.peak_rss_kb) / (double)base.peak_rss_kb * 100.0 : 0;
+            bool slower = change > threshold, more_allocs = r.allocs > base.allocs, bigger = rss_change > threshold;
+            regressions += slower || more_allocs || bigger;
+            printf("  %+6.1f%% %+6.1f%% rss%s%s%s", change, rss_change, slower ? "  SLOWER" : "",
+                   more_allocs ? "  MORE-ALLOCS" : "", bigger ? "  BIGGER" : "");
+        }
+        printf("\n");
+    }
+
+    fclose(out);
+    if (baseline != NULL) {
+        fclose(baseline);
+        printf("%d regression(s), threshold %.1f%%\n", regressions, threshold);
+    }
+    return regressions > 0;
+}
+
+int main(int argc_, char **argv_)
+{
+    if (argc_ > 1 && strcmp(argv_[1], "--suite") == 0) {
+        return bench_suite(argc_ > 2 ? argv_[2] : "bench_output.txt", NULL, 0);
+    }
+    if (argc_ > 2 && strcmp(argv_[1], "--compare") == 0) {
+        return bench_suite("bench_output.txt", argv_[2], argc_ > 3 ? atof(argv_[3]) : 10.0);
+    }
+
+    nflags = argc_ > 1 ? atoi(argv_[1]) : 128;
+    int max_threads = argc_ > 2 ? atoi(argv_[2]) : 0;
+    if (nflags <= 0 || max_threads < 0) {
+        fprintf(stderr, "Usage: %s [flags] [threads] | --suite [out] | --compare baseline [threshold]\n", argv_[0]);
+        return 1;
+    }
+
+    // 1. Generate the flag names and an argv that hits flags spread over the whole table.
+    names = malloc((size_t)nflags * sizeof(*names));
+    for (int i = 0; i < nflags; ++i) {
+        snprintf(names[i], sizeof(names[i]), "--flag%d", i);
+    }
+
+    static char *argv[1 + BENCH_TOKENS];
+    int argc = bench_argv(argv, BENCH_TOKENS, 0);
+
+    // 2. Time registration and parsing separately, and count the cache misses of parsing.
+#ifdef __linux__
+    int l1d_fd = bench_counter_open(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | PERF_COUNT_HW_CACHE_OP_READ << 8 |
+                                                        PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    int llc_fd = bench_counter_open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#else
+    int l1d_fd = -1, llc_fd = -1;
+#endif
+    long long l1d_misses = 0, llc_misses = 0;
+    double reg_ns = 0, parse_ns = 0;
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        cargs_reset();
+
+        double t0 = bench_now();
+        for (int i = 0; i < nflags; ++i) {
+            cargs_int(names[i], "benchmark flag", 0);
+        }
+        double t1 = bench_now();
+        long long l1d = bench_counter(l1d_fd), llc = bench_counter(llc_fd);
+        if (!cargs_parse(argc, argv)) {
+            cargs_log_error(stderr);
+            return 1;
+        }
+        l1d_misses += bench_counter(l1d_fd) - l1d;
+        llc_misses += bench_counter(llc_fd) - llc;
+        double t2 = bench_now();
+
+        reg_ns   += t1 - t0;
+        parse_ns += t2 - t1;
+    }
+
+    // Adopting a snapshot of the same schema replaces registration.
+    size_t snap_size = cargs_snapshot(NULL, 0, "bench");
+    void *snap = malloc(snap_size);
+    cargs_snapshot(snap, snap_size, "bench");
+    double adopt_ns = 0;
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        cargs_reset();
+        double t0 = bench_now();
+        if (!cargs_adopt(snap, snap_size, "bench")) return 1;
+        adopt_ns += bench_now() - t0;
+    }
+
+    printf("flags: %d, tokens: %d\n", nflags, argc - 1);
+    printf("register: %.2f ns/flag (adopt snapshot: %.2f ns/flag)\n", reg_ns / ((double)BENCH_ROUNDS * nflags),
+           adopt_ns / ((double)BENCH_ROUNDS * nflags));
+    printf("parse:    %.2f ns/token\n", parse_ns / ((double)BENCH_ROUNDS * (argc - 1)));
+    // lookups only read the first part of a flag; values, defaults and help text are in the second
+    printf("records:  %zu + %zu bytes/flag, registry %zu bytes\n", sizeof(struct cargs_flag), sizeof(struct cargs__flag_info),
+           cargs_get_stats().registry_bytes);
+    if (l1d_fd >= 0 || llc_fd >= 0) {
+        printf("misses:   %.2f L1d, %.2f last level per token\n", (double)l1d_misses / ((double)BENCH_ROUNDS * (argc - 1)),
+               (double)llc_misses / ((double)BENCH_ROUNDS * (argc - 1)));
+    } else {
+        printf("misses:   no cache counters (perf events unavailable)\n");
+    }
+
+    // 3. Independent contexts on 1..max_threads threads.
+    for (int threads = 1; threads <= max_threads; ++threads) {
+        pthread_t *tids = malloc((size_t)threads * sizeof(*tids));
+
+        double t0 = bench_now();
+        for (int t = 0; t < threads; ++t) {
+            pthread_create(&tids[t], NULL, bench_worker, (void *)(size_t)(t * 7919));
+        }
+        for (int t = 0; t < threads; ++t) {
+            pthread_join(tids[t], NULL);
+        }
+        double t1 = bench_now();
+
+        double lines = (double)threads * BENCH_LINES_PER_THREAD;
+        printf("threads: %2d, %.0f lines/s\n", threads, lines / ((t1 - t0) / 1e9));
+        free(tids);
+    }
+
+    // 4. Integer conversion: cargs_str2int() against strtoll() on the same numbers.
+    char (*numbers)[24] = malloc(BENCH_NUMBERS * sizeof(*numbers));
+    unsigned x = 12345;
+    for (int i = 0; i < BENCH_NUMBERS; ++i) {
+        x = x * 1103515245u + 12345u;
+        snprintf(numbers[i], sizeof(numbers[i]), "%lld", (long long)x * (long long)(x % 100000u) - 1000000000LL);
+    }
+
+    int64_t sum_cargs = 0, sum_libc = 0;
+    double t0 = bench_now();
+    for (int i = 0; i < BENCH_NUMBERS; ++i) {
+        int64_t v = 0;
+        cargs_str2int(&v, numbers[i], INT64_MIN, INT64_MAX);
+        sum_cargs += v;
+    }
+    double t1 = bench_now();
+    for (int i = 0; i < BENCH_NUMBERS; ++i) {
+        char *end;
+        errno = 0;
+        sum_libc += strtoll(numbers[i], &end, 10);
+    }
+    double t2 = bench_now();
+
+    printf("str2int:  %.2f ns/number (strtoll: %.2f ns/number)%s\n",
+           (t1 - t0) / BENCH_NUMBERS, (t2 - t1) / BENCH_NUMBERS, sum_cargs == sum_libc ? "" : " MISMATCH");
+
+    // 5. Double conversion: cargs_str2dbl() against strtod(), on short literals and on round-trip precision.
+    for (int digits = 6; digits <= 17; digits += 11) {
+        for (int i = 0; i < BENCH_NUMBERS; ++i) {
+            x = x * 1103515245u + 12345u;
+            snprintf(numbers[i], sizeof(numbers[i]), "%.*g", digits, (double)x / (double)(x % 1000u + 1u));
+        }
+
+        double dsum_cargs = 0, dsum_libc = 0;
+        t0 = bench_now();
+        for (int i = 0; i < BENCH_NUMBERS; ++i) {
+            double v = 0;
+            cargs_str2dbl(&v, numbers[i], -DBL_MAX, DBL_MAX);
+            dsum_cargs += v;
+        }
+        t1 = bench_now();
+        for (int i = 0; i < BENCH_NUMBERS; ++i) {
+            char *end;
+            dsum_libc += strtod(numbers[i], &end);
+        }
+        t2 = bench_now();
+
+        printf("str2dbl:  %.2f ns/number (strtod: %.2f ns/number), %d digits%s\n",
+               (t1 - t0) / BENCH_NUMBERS, (t2 - t1) / BENCH_NUMBERS, digits, dsum_cargs == dsum_libc ? "" : " MISMATCH");
+    }
+    free(numbers);
+
+    // 6. getopt_long(), which scans its table for every token, against cargs_getopt_long() on the same options.
+    struct option *opts = malloc(((size_t)nflags + 1) * sizeof(*opts));
+    cargs_option *cargs_opts = malloc(((size_t)nflags + 1) * sizeof(*cargs_opts));
+    for (int i = 0; i <= nflags; ++i) {
+        const char *name = i < nflags ? names[i] + 2 : NULL;
+        opts[i].name = name;
+        opts[i].has_arg = required_argument;
+        opts[i].flag = NULL;
+        opts[i].val = i;
+        cargs_opts[i].name = name;
+        cargs_opts[i].has_arg = CARGS_REQUIRED_ARGUMENT;
+        cargs_opts[i].flag = NULL;
+        cargs_opts[i].val = i;
+    }
+    static char getopt_tokens[BENCH_GETOPT_TOKENS][40];
+    static char *getopt_argv[1 + BENCH_GETOPT_TOKENS];
+    getopt_argv[0] = "bench";
+    for (int i = 0; i < BENCH_GETOPT_TOKENS; ++i) {
+        x = x * 1103515245u + 12345u;
+        snprintf(getopt_tokens[i], sizeof(getopt_tokens[i]), "%s=%u", names[x % (unsigned)nflags], x % 1000u);
+        getopt_argv[1 + i] = getopt_tokens[i];
+    }
+
+    long long vsum_libc = 0, vsum_cargs = 0;
+    int opt;
+    t0 = bench_now();
+    optind = 0;
+    while ((opt = getopt_long(1 + BENCH_GETOPT_TOKENS, getopt_argv, "+", opts, NULL)) >= 0) vsum_libc += opt;
+    t1 = bench_now();
+    cargs_optind = 0;
+    while ((opt = cargs_getopt_long(1 + BENCH_GETOPT_TOKENS, getopt_argv, "+", cargs_opts, NULL)) >= 0) vsum_cargs += opt;
+    t2 = bench_now();
+    printf("getopt:   %.2f ns/token (getopt_long: %.2f ns/token)%s\n",
+           (t2 - t1) / BENCH_GETOPT_TOKENS, (t1 - t0) / BENCH_GETOPT_TOKENS, vsum_cargs == vsum_libc ? "" : " MISMATCH");
+    free(opts);
+    free(cargs_opts);
+
+    cargs_free();
+    free(snap);
+    free(names);
+
+    return 0;
+}
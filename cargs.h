@@ -26,17 +26,26 @@ enum cargs_errors {
     CARGS_ERROR_UNDERFLOW,      ///< The provided number is below the minimum representable value.
     CARGS_ERROR_OUT_OF_BOUNDS,  ///< The value is outside the specified range (unused in current version).
     CARGS_ERROR_MISSING_POSITIONAL, ///< A mandatory positional argument was not provided.
+    CARGS_ERROR_RESPONSE_FILE,  ///< An @file argument could not be read, was malformed or nested too deeply.
+    CARGS_ERROR_CONFIG,         ///< A config file could not be read or has a line that is not "name = value".
+    CARGS_ERROR_AMBIGUOUS,      ///< An abbreviated long flag matches several flags; value lists them.
+    CARGS_ERROR_STREAM,         ///< An argument stream could not be read, holds an argument too long for its buffer, or flag cannot be fed from it.
 
     CARGS_ERROR_COUNT,
 
 };
-CARGS_STATIC_ASSERT(CARGS_ERROR_COUNT == 8, "Exhaustive cargs_error definition!");
+CARGS_STATIC_ASSERT(CARGS_ERROR_COUNT == 12, "Exhaustive cargs_error definition!");
 
 /// \brief Contains detailed information about a parsing error.
 typedef struct {
     enum cargs_errors error; ///< The type of error that occurred.
     char *flag;              ///< The name of the flag that caused the error.
     char *value;             ///< The value that caused the error (if applicable).
+    const char *source;      ///< The config file or "NAME=value" environment entry the error was found in, NULL for the command line.
+    uint32_t line;           ///< 1-based line in source, 0 if the file could not be read.
+    uint32_t column;         ///< 1-based column in source.
+    char *suggestions;       ///< For an unknown flag: the closest registered names, comma-separated, or NULL.
+    const char *command;     ///< The subcommand whose arguments held the error, NULL for the top level.
 } cargs_error;
 
 
@@ -169,36 +178,644 @@ void cargs_string_ref(const char *name, const char* desc, char **ref, const char
 /// \returns a pointer to the argument's value; call cargs_parse() to update it.
 char ** cargs_positional(const char *name, const char *desc, bool mandatory);
 
+/// \brief The values of a repeatable flag, in the order they were given.
+/// items is an array of count values of the flag's type (char * for string lists); it is NULL while the list is
+/// empty. All lists of a context share one allocation, so items may move on the next cargs_parse(),
+/// cargs_load_config() or cargs_load_env() and is released by cargs_reset() and cargs_free().
+typedef struct {
+    void *items;  ///< the values, contiguous
+    size_t count; ///< number of values
+} cargs_list;
+
+/// \brief Creates a positional that takes all remaining positional arguments.
+/// Its items (char **) point at the arguments in argv without copying them. If the arguments are adjacent, items is
+/// the slice of argv that holds them; if flags separate them, it is an array owned by the context. argv is never
+/// modified. Register it after all other positionals; it cannot be used with batch parsing.
+/// \param name  the name of the argument (for help output)
+/// \param desc  a short description of the argument
+/// \param mandatory whether at least one argument is required
+/// \returns the list, filled by cargs_parse().
+cargs_list * cargs_rest(const char *name, const char *desc, bool mandatory);
+
+/// \brief Creates a repeatable flag: every occurrence appends its value instead of replacing the last one.
+/// Boolean lists take no value and append true for each occurrence. Values from a config file or the environment
+/// are appended too, before those from the command line. String values point into argv without copying.
+/// \param name  the name of the flag
+/// \param desc  a short description of the flag
+/// \returns the flag's list, filled by cargs_parse().
+cargs_list * cargs_string_list(const char *name, const char *desc);
+/// \brief Creates a repeatable flag of the respective type; see cargs_string_list().
+cargs_list * cargs_bool_list(const char *name, const char *desc);
+cargs_list * cargs_char_list(const char *name, const char *desc);
+cargs_list * cargs_int8_list(const char *name, const char *desc);
+cargs_list * cargs_uint8_list(const char *name, const char *desc);
+cargs_list * cargs_int16_list(const char *name, const char *desc);
+cargs_list * cargs_uint16_list(const char *name, const char *desc);
+cargs_list * cargs_int32_list(const char *name, const char *desc);
+cargs_list * cargs_uint32_list(const char *name, const char *desc);
+cargs_list * cargs_int64_list(const char *name, const char *desc);
+cargs_list * cargs_uint64_list(const char *name, const char *desc);
+cargs_list * cargs_int_list(const char *name, const char *desc);
+cargs_list * cargs_size_t_list(const char *name, const char *desc);
+cargs_list * cargs_float_list(const char *name, const char *desc);
+cargs_list * cargs_double_list(const char *name, const char *desc);
+cargs_list * cargs_long_double_list(const char *name, const char *desc);
+
+/// \brief Allocation hook used for the flag registry.
+/// Must behave like realloc(ptr, new_size) when new_size > 0 and like free(ptr) when new_size is 0.
+/// old_size is the size of the block ptr points to (0 when ptr is NULL). Returning NULL for a
+/// non-zero new_size is treated as a fatal allocation failure.
+typedef void *(*cargs_alloc_fn)(void *user, void *ptr, size_t old_size, size_t new_size);
+
+/// \brief Bump allocator over a caller-provided buffer, for use with cargs_set_allocator().
+typedef struct {
+    char *base;  ///< start of the buffer
+    size_t size; ///< size of the buffer in bytes
+    size_t used; ///< bytes handed out so far; initialize to 0
+} cargs_arena;
+
+/// \brief Replaces the allocator used for the flag registry (default: realloc/free).
+/// Must be called before any flag is registered, or after cargs_free().
+/// \param fn   the allocation hook, or NULL to restore the default
+/// \param user passed through to fn, e.g. a cargs_arena
+void cargs_set_allocator(cargs_alloc_fn fn, void *user);
+
+/// \brief cargs_alloc_fn that hands out memory from the cargs_arena passed as user.
+void *cargs_arena_alloc(void *user, void *ptr, size_t old_size, size_t new_size);
+
+/// \brief Reserves room for nflags flags up front.
+/// Registering up to nflags flags afterwards performs no further allocations.
+/// \param nflags the number of flags to reserve room for
+void cargs_reserve(uint32_t nflags);
+
+/// \brief Resets the parser like cargs_reset() and releases all memory held by the registry.
+/// Pointers returned by the registration functions become invalid.
+void cargs_free(void);
+
 /// \brief Marks a flag as the help flag.
 /// When this flag is provided, cargs_parse() will skip mandatory positional argument validation.
 /// \param name The name of the flag to mark as help.
 void cargs_mark_help(const char *name);
 
+/// \brief Lets cargs_parse() accept unique prefixes of long flags, e.g. --verb for --verbose (off by default).
+/// Only flags whose name starts with "--" can be abbreviated; an exact name always wins. A prefix of several
+/// flags fails with CARGS_ERROR_AMBIGUOUS. Prefixes are resolved by binary search over the sorted names, which
+/// is built on the first parse after flags changed.
+void cargs_allow_abbrev(bool enable);
+
+/// \brief Defers the conversion of numeric values until they are read (off by default).
+/// cargs_parse() then only checks that a value consists of characters a number can contain and keeps the
+/// argument; cargs_value() converts it on first access and keeps the result. Overflows, range errors and
+/// malformed numbers surface there: cargs_value() returns NULL and cargs_get_error() describes the error.
+/// Call cargs_validate() after cargs_parse() to convert everything at once and fail early instead. The pointers
+/// returned at registration hold the previous value until the argument was converted.
+void cargs_lazy(bool enable);
+
+/// \brief Converts all values deferred by cargs_lazy().
+/// \returns false if one of them is invalid; cargs_get_error() describes the first.
+bool cargs_validate(void);
+
+/// \brief Registers alias as a second name of the flag name, e.g. "-v" for "--verbose".
+/// Both names set the same value; help output lists the flag once, with its last alias.
+void cargs_alias(const char *alias, const char *name);
+
 /// \brief Parses the flags given to the program and checks for matching flags.
 /// The first entry of the argv array (program name) is skipped.
+/// Values may also be attached as --name=value or -ovalue, and boolean short flags clustered as -abc; argv
+/// itself is never modified.
+/// Arguments of the form @path are replaced by the arguments stored in the file path, which may name further
+/// response files up to CARGS_RESPONSE_DEPTH levels deep. String values taken from a response file point into
+/// it and stay valid until cargs_reset() or cargs_free().
 /// \param argc  The number of arguments in argv.
 /// \param argv  The array of argument strings.
 /// \returns true if parsing was successful, false if an error occurred.
 bool cargs_parse(int argc, char **argv);
 
+/// \brief Applies a config file of "name = value" lines to the registered flags.
+/// Names match a flag as written or with "--" or "-" in front; values use the same conversions as cargs_parse(),
+/// and booleans accept true/false, yes/no, on/off and 1/0. Blank lines and lines starting with '#' are skipped,
+/// and a value in double quotes keeps its whitespace. Call it before cargs_parse(), so the command line
+/// overrides the file; of several files the last one wins. The file stays loaded until cargs_reset() or
+/// cargs_free(), since string values point into it.
+/// \param path The config file to read; errors refer to it, so it must outlive them.
+/// \returns true on success, false with the error's source, line and column set otherwise.
+bool cargs_load_config(const char *path);
+
+/// \brief Binds a flag to an environment variable read by cargs_load_env().
+/// \param name The name of a registered flag.
+/// \param env  The variable name, e.g. "MYAPP_THREADS"; it must outlive the registry.
+void cargs_bind_env(const char *name, const char *env);
+
+/// \brief Fills flags from the environment in a single pass over environ.
+/// A variable sets the flag bound to it with cargs_bind_env(), or, when prefix is not NULL and the variable
+/// starts with it, the flag named by the rest in lower case with '_' as '-' (MYAPP_DRY_RUN sets --dry-run).
+/// Other variables are ignored. Values are converted like config values. For default < config < env < argv,
+/// call cargs_load_config(), then cargs_load_env(), then cargs_parse().
+/// \returns true on success, false with the error's source set to the offending "NAME=value" entry otherwise.
+bool cargs_load_env(const char *prefix);
+
+/// \brief Serializes the registered flags into a snapshot: names, types, defaults and the prebuilt lookup index.
+/// Write it to a file for cargs_adopt_file(), or embed it in the program for cargs_adopt().
+/// \param buf       receives the snapshot if it is large enough; may be NULL when size is 0
+/// \param size      bytes available in buf
+/// \param schema_id identifies the registration code, e.g. a version or build id; cargs_adopt() requires the same
+/// \returns the size of the snapshot, which was only written if it is not larger than size.
+size_t cargs_snapshot(void *buf, size_t size, const char *schema_id);
+
+/// \brief Registers all flags of a snapshot at once, using its lookup index in place instead of rebuilding it.
+/// Flags adopted this way store their values internally (bindings to variables are not kept); get them with
+/// cargs_value(). The snapshot must stay valid until cargs_reset() or cargs_free().
+/// \returns false, leaving the registry empty, if the snapshot was written for another schema_id, by a build
+/// with a different layout, or is damaged; the caller should register its flags normally then.
+bool cargs_adopt(const void *blob, size_t size, const char *schema_id);
+
+/// \brief Like cargs_adopt(), with the snapshot memory-mapped from path.
+bool cargs_adopt_file(const char *path, const char *schema_id);
+
+/// \brief Returns a pointer to the value of the flag registered as name, or NULL if there is none.
+void *cargs_value(const char *name);
+
 /// \brief Logs the current parsing error to the specified stream.
 /// Only call this function if cargs_parse() returned false.
 /// \param stream The output stream (e.g., stderr).
 void cargs_log_error(FILE *stream);
 
+/// \brief Logs the given parsing error to the specified stream.
+/// Used by cargs_log_error() and by parsers generated with cargs_gen.
+/// \param stream The output stream (e.g., stderr).
+/// \param err    The error to describe.
+void cargs_print_error(FILE *stream, cargs_error err);
+
 /// \brief Returns a structure containing details about the last parsing error.
 /// \return A cargs_error struct containing the error type, flag name, and value.
 cargs_error cargs_get_error();
 
 /// \brief Prints the registered flags, their descriptions, and default values.
+/// Descriptions start in one column and wrap at the width of the terminal behind stream. The text is rendered
+/// into a buffer that is cached until flags are added, and written with a single fwrite().
 /// \param stream The output stream (e.g., stdout).
 /// \param printdefault Whether to print the default values for each flag.
 void cargs_log_options(FILE *stream, bool printdefault);
 
+/// \brief Renders the output of cargs_log_options(stream, true) into buf, wrapped to $COLUMNS or
+/// CARGS_HELP_WIDTH (80) columns.
+/// The text is rendered once and cached until flags are added, so repeated help output costs one copy; it is
+/// NUL-terminated when it fits.
+/// \returns the length of the text, which was only written if it is smaller than len.
+size_t cargs_render_options(char *buf, size_t len);
+
 /// \brief Resets the parser to its initial state, clearing all registered flags and errors.
 /// Useful for testing and any scenario requiring re-registration and re-parsing.
 void cargs_reset(void);
 
+/// \brief Counters collected by cargs_parse() and cargs_log_options().
+/// The counters and match hooks are compiled in only when CARGS_STATS is defined before the implementation is
+/// included; otherwise they stay zero and cost nothing. flags and registry_bytes are always filled in.
+/// Batch parsing is not counted, since rows may be parsed on several threads at once.
+typedef struct {
+    uint64_t parses;          ///< calls to cargs_parse()
+    uint64_t tokens;          ///< arguments examined, program name excluded
+    uint64_t lookups;         ///< hash index lookups
+    uint64_t probes;          ///< index slots visited by those lookups
+    uint64_t compares;        ///< name comparisons after a hash match
+    uint64_t bools;           ///< boolean flags set
+    uint64_t ints;            ///< signed integer values converted, all widths
+    uint64_t uints;           ///< unsigned integer and size_t values converted
+    uint64_t floats;          ///< float, double and long double values converted
+    uint64_t strings;         ///< string and char values stored
+    uint64_t positionals;     ///< positional arguments assigned
+    uint64_t parse_ns;        ///< time spent in cargs_parse()
+    uint64_t log_options_ns;  ///< time spent in cargs_log_options()
+    uint32_t flags;           ///< registered flags
+    size_t registry_bytes;    ///< memory held by the registry: flag chunks, index and loaded files
+} cargs_stats;
+
+/// \brief Called by cargs_parse() for every matched flag and assigned positional (requires CARGS_STATS).
+/// \param user  the pointer given to cargs_set_match_hook()
+/// \param name  the registered name of the flag or positional
+/// \param value the argument stored, or NULL for a boolean flag
+typedef void (*cargs_match_fn)(void *user, const char *name, const char *value);
+
+/// \brief Returns the counters collected so far and the current size of the registry.
+cargs_stats cargs_get_stats(void);
+
+/// \brief Sets all counters to zero.
+void cargs_reset_stats(void);
+
+/// \brief Installs a hook called on each flag match, e.g. to export them to telemetry; NULL removes it.
+void cargs_set_match_hook(cargs_match_fn fn, void *user);
+
+/// \brief Converts a string to a signed integer and checks that it lies within [min, max].
+/// These converters back cargs_parse() and are exposed for generated parsers and custom sources.
+/// \param out  receives the value on success
+/// \param s    the string to convert
+/// \param min  the smallest accepted value
+/// \param max  the largest accepted value
+/// \returns CARGS_ERROR_NONE on success, otherwise the conversion error.
+enum cargs_errors cargs_str2int(int64_t *out, const char *s, int64_t min, int64_t max);
+/// \brief Converts a string to an unsigned integer and checks that it lies within [min, max].
+enum cargs_errors cargs_str2uint(uint64_t *out, const char *s, uint64_t min, uint64_t max);
+/// \brief Converts a string to the nearest float and checks that it lies within [min, max].
+/// Accepts decimal and 0x hexadecimal notation independently of the locale; nan and inf are rejected. A value too
+/// large for the type is CARGS_ERROR_OUT_OF_BOUNDS, and only one too large for a long double is an overflow.
+enum cargs_errors cargs_str2flt(float *out, const char *s, float min, float max);
+/// \brief Converts a string to the nearest double and checks that it lies within [min, max].
+/// Same notation and errors as cargs_str2flt().
+enum cargs_errors cargs_str2dbl(double *out, const char *s, double min, double max);
+/// \brief Converts a string to a long double with strtold() and checks that it lies within [min, max].
+enum cargs_errors cargs_str2float(long double *out, const char *s, long double min, long double max);
+
+#define CARGS__MAX_CHUNKS 32
+
+/// \brief An independent parser: its own registry, parse state and error.
+/// The global functions above operate on a default context; the cargs_ctx_* functions below take one
+/// explicitly, so different contexts can be used from different threads at the same time.
+/// Treat the members as private. Zero-initialize it or call cargs_ctx_init() before use.
+typedef struct cargs_ctx {
+    struct cargs_flag *chunks[CARGS__MAX_CHUNKS]; ///< flag storage, chunk k holds CARGS_CHUNK_FLAGS << k flags
+    struct cargs__flag_info *infos[CARGS__MAX_CHUNKS]; ///< the rest of each flag, in chunks parallel to chunks
+    uint32_t nchunks;      ///< number of allocated chunks
+    uint32_t capacity;     ///< number of flags the allocated chunks can hold
+    uint32_t count;        ///< number of registered flags
+    uint32_t *index;       ///< hash index over flag names
+    uint32_t index_cap;    ///< number of slots in index
+    bool index_shared;     ///< index points into an adopted snapshot and is copied before it changes
+    cargs_alloc_fn alloc_fn; ///< allocation hook, NULL for realloc/free
+    void *alloc_user;      ///< passed through to alloc_fn
+    bool parsed;           ///< whether cargs_ctx_parse() was called
+    cargs_error err;       ///< the last parsing error
+    char **rsp_argv;       ///< argv with response files expanded, pointing into rsp_files
+    uint32_t rsp_argc;     ///< number of arguments in rsp_argv
+    uint32_t rsp_argv_cap; ///< number of slots in rsp_argv
+    struct cargs__rsp_file *rsp_files; ///< response and config files, kept until reset
+    uint32_t rsp_nfiles;   ///< number of loaded response files
+    uint32_t rsp_files_cap; ///< number of slots in rsp_files
+    struct cargs__list_item *list_items; ///< values of list flags in the order they were given
+    uint32_t list_nitems;  ///< number of entries in list_items
+    uint32_t list_items_cap; ///< number of slots in list_items
+    char *list_arena;      ///< the contiguous arrays of all list flags, rebuilt from list_items
+    size_t list_arena_size; ///< bytes owned by list_arena
+    bool abbrev;           ///< whether unique prefixes of long flags are accepted
+    struct cargs__abbrev *abbrev_names; ///< long flags sorted by name, for prefix lookups
+    uint32_t abbrev_count; ///< number of entries in abbrev_names
+    uint32_t abbrev_cap;   ///< number of slots in abbrev_names
+    uint32_t abbrev_built; ///< ctx->count when abbrev_names was built
+    char *err_text;        ///< names listed by the last error: ambiguous candidates or suggestions
+    size_t err_text_size;  ///< bytes owned by err_text
+    struct cargs__suggest_index *suggest; ///< flag names by length and trigram, built for the first suggestion
+    cargs_stats stats;     ///< counters, only updated with CARGS_STATS
+    cargs_match_fn match_fn; ///< match hook, only called with CARGS_STATS
+    void *match_user;      ///< passed through to match_fn
+    struct cargs__command *commands; ///< registered subcommands
+    uint32_t ncommands;    ///< number of entries in commands
+    uint32_t commands_cap; ///< number of slots in commands
+    uint32_t command;      ///< 1 + index of the selected subcommand, 0 before one was selected
+    struct cargs_ctx *command_ctx; ///< the flags of the selected subcommand, allocated once one is selected
+    bool lazy;             ///< whether numeric values are converted on first access
+    uint32_t *pending;     ///< flags whose raw argument is not converted yet
+    uint32_t npending;     ///< number of entries in pending
+    uint32_t pending_cap;  ///< number of slots in pending
+    char *help_text;       ///< the last rendered help text
+    size_t help_size;      ///< bytes owned by help_text
+    size_t help_len;       ///< length of the help text, 0 if there is none
+    size_t help_width;     ///< terminal width it was rendered for
+    uint32_t help_count;   ///< ctx->count when it was rendered
+    uint32_t help_commands; ///< ctx->ncommands when it was rendered
+    bool help_defaults;    ///< whether it shows default values
+    char *stream_buf;      ///< read buffer of CARGS_STREAM_BUFFER + 1 bytes for argument streams, NULL until used
+    char *stream_held;     ///< an argument held back as a flag's possible value, copied out of a full stream_buf
+    size_t stream_held_size; ///< bytes owned by stream_held
+    struct cargs__stream_value *stream_values; ///< per flag, its string value copied out of stream_buf
+    uint32_t stream_nvalues; ///< number of entries in stream_values
+} cargs_ctx;
+
+/// \brief Initializes a context with no flags and the default allocator.
+void cargs_ctx_init(cargs_ctx *ctx);
+
+/// \brief Context variants of the registration functions above.
+bool * cargs_ctx_bool(cargs_ctx *ctx, const char *name, const char *desc, bool def);
+void cargs_ctx_bool_ref(cargs_ctx *ctx, const char *name, const char *desc, bool *ref, bool def);
+char * cargs_ctx_char(cargs_ctx *ctx, const char *name, const char *desc, char def);
+void cargs_ctx_char_ref(cargs_ctx *ctx, const char *name, const char *desc, char *ref, char def);
+int8_t * cargs_ctx_int8(cargs_ctx *ctx, const char *name, const char *desc, int8_t def);
+void cargs_ctx_int8_ref(cargs_ctx *ctx, const char *name, const char *desc, int8_t *ref, int8_t def);
+uint8_t * cargs_ctx_uint8(cargs_ctx *ctx, const char *name, const char *desc, uint8_t def);
+void cargs_ctx_uint8_ref(cargs_ctx *ctx, const char *name, const char *desc, uint8_t *ref, uint8_t def);
+int16_t * cargs_ctx_int16(cargs_ctx *ctx, const char *name, const char *desc, int16_t def);
+void cargs_ctx_int16_ref(cargs_ctx *ctx, const char *name, const char *desc, int16_t *ref, int16_t def);
+uint16_t * cargs_ctx_uint16(cargs_ctx *ctx, const char *name, const char *desc, uint16_t def);
+void cargs_ctx_uint16_ref(cargs_ctx *ctx, const char *name, const char *desc, uint16_t *ref, uint16_t def);
+int32_t * cargs_ctx_int32(cargs_ctx *ctx, const char *name, const char *desc, int32_t def);
+void cargs_ctx_int32_ref(cargs_ctx *ctx, const char *name, const char *desc, int32_t *ref, int32_t def);
+uint32_t * cargs_ctx_uint32(cargs_ctx *ctx, const char *name, const char *desc, uint32_t def);
+void cargs_ctx_uint32_ref(cargs_ctx *ctx, const char *name, const char *desc, uint32_t *ref, uint32_t def);
+int64_t * cargs_ctx_int64(cargs_ctx *ctx, const char *name, const char *desc, int64_t def);
+void cargs_ctx_int64_ref(cargs_ctx *ctx, const char *name, const char *desc, int64_t *ref, int64_t def);
+uint64_t * cargs_ctx_uint64(cargs_ctx *ctx, const char *name, const char *desc, uint64_t def);
+void cargs_ctx_uint64_ref(cargs_ctx *ctx, const char *name, const char *desc, uint64_t *ref, uint64_t def);
+int * cargs_ctx_int(cargs_ctx *ctx, const char *name, const char *desc, int def);
+void cargs_ctx_int_ref(cargs_ctx *ctx, const char *name, const char *desc, int *ref, int def);
+size_t * cargs_ctx_size_t(cargs_ctx *ctx, const char *name, const char *desc, size_t def);
+void cargs_ctx_size_t_ref(cargs_ctx *ctx, const char *name, const char *desc, size_t *ref, size_t def);
+float * cargs_ctx_float(cargs_ctx *ctx, const char *name, const char *desc, float def);
+void cargs_ctx_float_ref(cargs_ctx *ctx, const char *name, const char *desc, float *ref, float def);
+double * cargs_ctx_double(cargs_ctx *ctx, const char *name, const char *desc, double def);
+void cargs_ctx_double_ref(cargs_ctx *ctx, const char *name, const char *desc, double *ref, double def);
+long double * cargs_ctx_long_double(cargs_ctx *ctx, const char *name, const char *desc, long double def);
+void cargs_ctx_long_double_ref(cargs_ctx *ctx, const char *name, const char *desc, long double *ref, long double def);
+char ** cargs_ctx_string(cargs_ctx *ctx, const char *name, const char *desc, const char *def);
+void cargs_ctx_string_ref(cargs_ctx *ctx, const char *name, const char *desc, char **ref, const char *def);
+char ** cargs_ctx_positional(cargs_ctx *ctx, const char *name, const char *desc, bool mandatory);
+/// \brief Context variants of the list flag constructors.
+cargs_list * cargs_ctx_bool_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_char_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_int8_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_uint8_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_int16_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_uint16_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_int32_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_uint32_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_int64_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_uint64_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_int_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_size_t_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_float_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_double_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_long_double_list(cargs_ctx *ctx, const char *name, const char *desc);
+cargs_list * cargs_ctx_string_list(cargs_ctx *ctx, const char *name, const char *desc);
+/// \brief Context variant of cargs_rest().
+cargs_list * cargs_ctx_rest(cargs_ctx *ctx, const char *name, const char *desc, bool mandatory);
+
+/// \brief Context variant of cargs_mark_help().
+void cargs_ctx_mark_help(cargs_ctx *ctx, const char *name);
+/// \brief Context variant of cargs_allow_abbrev().
+void cargs_ctx_allow_abbrev(cargs_ctx *ctx, bool enable);
+/// \brief Context variant of cargs_lazy().
+void cargs_ctx_lazy(cargs_ctx *ctx, bool enable);
+/// \brief Context variant of cargs_validate().
+bool cargs_ctx_validate(cargs_ctx *ctx);
+/// \brief Context variant of cargs_alias().
+void cargs_ctx_alias(cargs_ctx *ctx, const char *alias, const char *name);
+/// \brief Context variant of cargs_parse().
+bool cargs_ctx_parse(cargs_ctx *ctx, int argc, char **argv);
+/// \brief Context variant of cargs_load_config().
+bool cargs_ctx_load_config(cargs_ctx *ctx, const char *path);
+/// \brief Context variant of cargs_bind_env().
+void cargs_ctx_bind_env(cargs_ctx *ctx, const char *name, const char *env);
+/// \brief Context variant of cargs_load_env().
+bool cargs_ctx_load_env(cargs_ctx *ctx, const char *prefix);
+/// \brief Context variant of cargs_snapshot().
+size_t cargs_ctx_snapshot(cargs_ctx *ctx, void *buf, size_t size, const char *schema_id);
+/// \brief Context variant of cargs_adopt().
+bool cargs_ctx_adopt(cargs_ctx *ctx, const void *blob, size_t size, const char *schema_id);
+/// \brief Context variant of cargs_adopt_file().
+bool cargs_ctx_adopt_file(cargs_ctx *ctx, const char *path, const char *schema_id);
+/// \brief Context variant of cargs_value().
+void *cargs_ctx_value(cargs_ctx *ctx, const char *name);
+/// \brief Context variant of cargs_log_error().
+void cargs_ctx_log_error(cargs_ctx *ctx, FILE *stream);
+/// \brief Context variant of cargs_get_error().
+cargs_error cargs_ctx_get_error(cargs_ctx *ctx);
+/// \brief Context variant of cargs_log_options().
+void cargs_ctx_log_options(cargs_ctx *ctx, FILE *stream, bool printdefault);
+/// \brief Context variant of cargs_render_options().
+size_t cargs_ctx_render_options(cargs_ctx *ctx, char *buf, size_t len);
+/// \brief Context variant of cargs_reset().
+void cargs_ctx_reset(cargs_ctx *ctx);
+/// \brief Context variant of cargs_get_stats().
+cargs_stats cargs_ctx_get_stats(cargs_ctx *ctx);
+/// \brief Context variant of cargs_reset_stats().
+void cargs_ctx_reset_stats(cargs_ctx *ctx);
+/// \brief Context variant of cargs_set_match_hook().
+void cargs_ctx_set_match_hook(cargs_ctx *ctx, cargs_match_fn fn, void *user);
+/// \brief Context variant of cargs_set_allocator().
+void cargs_ctx_set_allocator(cargs_ctx *ctx, cargs_alloc_fn fn, void *user);
+/// \brief Context variant of cargs_reserve().
+void cargs_ctx_reserve(cargs_ctx *ctx, uint32_t nflags);
+/// \brief Context variant of cargs_free(); the context can be reused afterwards.
+void cargs_ctx_free(cargs_ctx *ctx);
+
+/// \brief Results of parsing many argv vectors against one set of flags.
+/// Values are stored column-wise: one contiguous array per registered flag, indexed by row.
+typedef struct {
+    cargs_ctx *schema;   ///< the context whose flags define the columns
+    uint32_t nflags;     ///< number of flags (columns) when the batch was created
+    size_t rows;         ///< number of rows
+    void **columns;      ///< per flag, an array of rows values of the flag's type
+    cargs_error *errors; ///< per row, the parsing error (CARGS_ERROR_NONE on success)
+} cargs_batch;
+
+/// \brief Prepares a batch of rows for the flags registered in schema.
+/// Every cell starts out with its flag's default value. The schema must not gain flags afterwards.
+/// \param batch  the batch to initialize
+/// \param schema the context holding the registered flags, or NULL for the default context
+/// \param rows   the number of argv vectors to be parsed
+void cargs_batch_init(cargs_batch *batch, cargs_ctx *schema, size_t rows);
+
+/// \brief Parses the rows [first, first + count) of a batch.
+/// Row r is parsed from argcs[r] / argvs[r]. Its values land in the columns, its error in errors[r].
+/// Calls for disjoint row ranges of the same batch may run concurrently, e.g. spread over a worker pool.
+/// \returns the number of rows in the range that failed to parse.
+size_t cargs_batch_parse(cargs_batch *batch, size_t first, size_t count, const int *argcs, char **const *argvs);
+
+/// \brief Returns the column of the flag called name, or NULL if there is no such flag.
+/// The column holds batch->rows values of the flag's type, e.g. int32_t for cargs_int32().
+const void *cargs_batch_column(const cargs_batch *batch, const char *name);
+
+/// \brief Releases the memory of a batch.
+void cargs_batch_free(cargs_batch *batch);
+
+// live reload: values reloaded while the program runs and read lock-free from other threads
+
+// Live values need atomic operations: the GCC and Clang builtins, MSVC's interlocked functions or C11
+// <stdatomic.h>. Other compilers leave the cargs_live_* functions out and define CARGS_LIVE as 0.
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER) || (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_ATOMICS__))
+#   define CARGS_LIVE 1
+#else
+#   define CARGS_LIVE 0
+#endif // atomics
+
+#if CARGS_LIVE
+/// \brief One immutable set of flag values. It never changes once published; a reload publishes a new one.
+typedef struct {
+    cargs_ctx *schema; ///< the context whose flags the values belong to
+    uint64_t version;  ///< 1 for the values cargs_live_init() starts with, one more for every reload
+    uint32_t nflags;   ///< number of flags (values)
+    void *values;      ///< per flag, a slot holding its value; read it with cargs_live_value()
+    size_t size;       ///< bytes of the set, with copies of its string values
+} cargs_live_values;
+
+/// \brief Flag values that can be reloaded while other threads read them, read-copy-update style.
+/// A reload builds a new set and publishes it with an atomic pointer swap, so readers never see a half-applied
+/// reload, and frees the old set once the readers that might still hold it have released it.
+typedef struct {
+    cargs_ctx *schema;     ///< the context whose flags the values belong to
+    uint32_t nflags;       ///< number of flags when the live values were created
+    void *current;         ///< the published cargs_live_values; take it with cargs_live_acquire()
+    long epoch;            ///< which of the two reader counters new readers join
+    long readers[32];      ///< the reader counters, at [0] and [16] so they sit on different cache lines
+    char *config;          ///< the config file of the last reload, which err may point into
+    size_t config_size;    ///< bytes owned by config
+    bool config_mapped;    ///< whether config is a private mapping rather than an allocation
+    cargs_error err;       ///< the error of the last failed reload
+} cargs_live;
+
+/// \brief A set of values held by a reader; hand it back with cargs_live_release().
+typedef struct {
+    const cargs_live_values *values; ///< the values to read until the release
+    long slot;                       ///< the reader counter it holds
+} cargs_live_read;
+
+/// \brief Publishes the current values of the flags registered in schema, e.g. right after cargs_parse().
+/// The schema must not change while the live values exist: no flags registered, no reset, no free. It cannot have
+/// subcommands or list flags. Values deferred by cargs_lazy() are converted first.
+/// \param live   the live values to initialize
+/// \param schema the context holding the registered flags, or NULL for the default context
+/// \returns true on success; false if a deferred value is invalid, with live->err describing it and nothing
+/// published, so the live values can only be freed.
+bool cargs_live_init(cargs_live *live, cargs_ctx *schema);
+
+/// \brief Builds a new set of values and publishes it: defaults, then the config file, then argv.
+/// Either source may be left out with NULL / 0; argv[0] is skipped like in cargs_parse(), and response files
+/// are not expanded. String values are copied, so argv need not outlive the call. Once published, the call waits
+/// until readers that took the previous set have released it, then frees it. Reloads must not overlap.
+/// \returns true on success; on errors the published values stay as they are and live->err describes the error.
+bool cargs_live_reload(cargs_live *live, const char *config, int argc, char **argv);
+
+/// \brief Takes the published values for reading, without locks; any number of threads may read at once.
+/// Keep the read short, since a reload waits for it before freeing the values it replaced.
+cargs_live_read cargs_live_acquire(cargs_live *live);
+
+/// \brief Hands back values taken with cargs_live_acquire(); they must not be read afterwards.
+void cargs_live_release(cargs_live *live, cargs_live_read read);
+
+/// \brief Returns the value of the flag called name in values, or NULL if there is no such flag.
+/// The value has the flag's type, e.g. int32_t for cargs_int32(); finding it costs one lookup in the index.
+const void *cargs_live_value(const cargs_live_values *values, const char *name);
+
+/// \brief Releases the live values; no reader may hold them any more.
+void cargs_live_free(cargs_live *live);
+#endif // CARGS_LIVE
+
+// subcommands: each registers its flags only when it is selected
+
+/// \brief Registers the flags of a subcommand on ctx with the cargs_ctx_* functions; user is passed through.
+typedef void (*cargs_command_fn)(cargs_ctx *ctx, void *user);
+
+/// \brief Adds a subcommand, as in "tool build -j 4".
+/// cargs_parse() reads the top-level flags up to the first argument that is no flag, which must name a
+/// subcommand. Only then is setup called, on a fresh context for that subcommand, and the remaining arguments are
+/// parsed against it; flags of the other subcommands are never registered. A program with subcommands has no
+/// positionals of its own, and cargs_parse() fails unless a subcommand or a help flag was given.
+void cargs_command(const char *name, const char *desc, cargs_command_fn setup, void *user);
+
+/// \brief Returns the name of the subcommand selected by cargs_parse(), or NULL if there was none.
+const char *cargs_selected_command(void);
+
+/// \brief Returns the context holding the flags of the selected subcommand, or NULL if there was none.
+/// Pass it to cargs_ctx_log_options() for the subcommand's help or to cargs_ctx_value(). Errors of the subcommand
+/// are also reported by cargs_get_error(), with cargs_error.command set. The context is released by
+/// cargs_reset() and cargs_free().
+cargs_ctx *cargs_command_ctx(void);
+
+/// \brief Context variant of cargs_command().
+void cargs_ctx_command(cargs_ctx *ctx, const char *name, const char *desc, cargs_command_fn setup, void *user);
+/// \brief Context variant of cargs_selected_command().
+const char *cargs_ctx_selected_command(cargs_ctx *ctx);
+/// \brief Context variant of cargs_command_ctx().
+cargs_ctx *cargs_ctx_command_ctx(cargs_ctx *ctx);
+
+// shell completion: the scripts ask the program, which answers from its registered flags
+
+/// \brief Answers a completion query and returns true if argv is one; the program should exit right after.
+/// The scripts of cargs_completion_script() run "prog __cargs_complete <index> <words...>" on Tab, where words is
+/// the command line and index the position of the word being completed. Call this right after registering the
+/// flags (or adopting a snapshot) and before any other initialization, so the query costs no more than that.
+/// It prints a "candidate<TAB>description" line for every flag or subcommand that starts with the word, or the
+/// line ":files" where a file name fits: the value of a string flag or a positional. Numeric values get nothing.
+bool cargs_complete(int argc, char **argv);
+
+/// \brief Writes the completion script for the program prog to stream; shell is "bash", "zsh" or "fish".
+/// \returns false for any other shell.
+bool cargs_completion_script(FILE *stream, const char *shell, const char *prog);
+
+/// \brief Context variant of cargs_complete().
+bool cargs_ctx_complete(cargs_ctx *ctx, int argc, char **argv);
+
+// streaming: arguments read in chunks from a file descriptor or a callback, as from "find -print0 | tool"
+
+/// \brief Reads up to size bytes of an argument stream into buf.
+/// \returns the number of bytes read, 0 at the end of the stream, or a negative number on errors.
+typedef long (*cargs_read_fn)(void *user, char *buf, size_t size);
+
+/// \brief Receives one argument of the rest positional; arg is only valid during the call.
+typedef void (*cargs_rest_fn)(void *user, const char *arg);
+
+/// \brief Parses argv and then the arguments read from fd, separated by delim ('\0' or '\n').
+/// The stream continues the command line, so it may hold flags as well as positionals. It is read into one buffer
+/// of CARGS_STREAM_BUFFER bytes and parsed as it arrives, so memory stays bounded however long the stream is:
+/// arguments for a rest positional go to rest instead of its list, and string values are copied out of the
+/// buffer, one copy per flag. A last argument without delimiter counts as well, and an empty line or a lone
+/// '\0' is an empty argument. Arguments of the stream are not expanded as response files and not converted
+/// lazily; a flag at the end of argv cannot take its value from the stream. An unreadable stream fails with
+/// CARGS_ERROR_STREAM, and so does, before anything is read, a program with subcommands or repeatable string
+/// flags, or with a rest positional when rest is NULL.
+bool cargs_parse_fd(int argc, char **argv, int fd, char delim, cargs_rest_fn rest, void *rest_user);
+
+/// \brief cargs_parse_fd() for a stream read by read(read_user, buf, size).
+bool cargs_parse_stream(int argc, char **argv, cargs_read_fn read, void *read_user, char delim, cargs_rest_fn rest, void *rest_user);
+
+/// \brief Context variant of cargs_parse_fd().
+bool cargs_ctx_parse_fd(cargs_ctx *ctx, int argc, char **argv, int fd, char delim, cargs_rest_fn rest, void *rest_user);
+/// \brief Context variant of cargs_parse_stream().
+bool cargs_ctx_parse_stream(cargs_ctx *ctx, int argc, char **argv, cargs_read_fn read, void *read_user, char delim, cargs_rest_fn rest, void *rest_user);
+
+// getopt shim: a drop-in for getopt() and getopt_long() for code that is not ported to flags yet
+
+/// \brief Values of cargs_option.has_arg, matching no_argument, required_argument and optional_argument.
+#define CARGS_NO_ARGUMENT       0
+#define CARGS_REQUIRED_ARGUMENT 1
+#define CARGS_OPTIONAL_ARGUMENT 2
+
+/// \brief A long option, laid out like struct option of <getopt.h>. Tables end with an entry whose name is NULL.
+typedef struct cargs_option {
+    const char *name;
+    int has_arg; ///< CARGS_NO_ARGUMENT, CARGS_REQUIRED_ARGUMENT or CARGS_OPTIONAL_ARGUMENT
+    int *flag;   ///< if not NULL, receives val and cargs_getopt_long() returns 0
+    int val;
+} cargs_option;
+
+/// \brief Like optarg, optind, opterr and optopt. Set cargs_optind to 0 to start over, e.g. on another argv.
+extern char *cargs_optarg;
+extern int cargs_optind;
+extern int cargs_opterr;
+extern int cargs_optopt;
+
+/// \brief Works like getopt_long(), but never permutes argv: scanning stops at the first argument that is no
+/// option (POSIX order, as with a leading '+' in optstring or POSIXLY_CORRECT), or, with a leading '-', returns
+/// it as the argument of option 1. A leading ':' returns ':' for a missing argument and silences the messages.
+/// Long options are found through a hash table built on the first call for each table, and may be abbreviated
+/// to a unique prefix; the table must not change until cargs_optind is reset to 0. Like getopt_long(), the
+/// state is global, so calls must not overlap between threads.
+int cargs_getopt_long(int argc, char *const argv[], const char *optstring, const cargs_option *longopts, int *longindex);
+
+/// \brief cargs_getopt_long() without long options, like getopt().
+int cargs_getopt(int argc, char *const argv[], const char *optstring);
+
+#ifdef CARGS_GETOPT_NAMES
+/// Lets existing getopt_long() code build against the shim unchanged; do not include <getopt.h> with it.
+#   define option            cargs_option
+#   define no_argument       CARGS_NO_ARGUMENT
+#   define required_argument CARGS_REQUIRED_ARGUMENT
+#   define optional_argument CARGS_OPTIONAL_ARGUMENT
+#   define optarg            cargs_optarg
+#   define optind            cargs_optind
+#   define opterr            cargs_opterr
+#   define optopt            cargs_optopt
+#   define getopt_long       cargs_getopt_long
+#   define getopt            cargs_getopt
+#endif // CARGS_GETOPT_NAMES
+
 #ifdef __cplusplus
 
 }
@@ -206,9 +823,10 @@ void cargs_reset(void);
 
 #endif // CARGS_H
 
-#ifdef CARGS_IMPLEMENTATION
+// guarded so that headers which include cargs.h again (e.g. generated parsers) don't redefine it
+#if defined(CARGS_IMPLEMENTATION) && !defined(CARGS__IMPLEMENTED)
+#define CARGS__IMPLEMENTED
 
-#include <ctype.h>
 #include <errno.h>
 #include <float.h>
 #include <inttypes.h>
@@ -258,45 +876,240 @@ union cargs_value {
     long double long_double;
     char *   string;
     size_t   size;
+    cargs_list list;
 };
 
+// The part of a flag that lookups and the parse loop read. It is kept to 24 bytes, so probing the index touches
+// little memory and the array of all flags stays small enough to remain cached; the rest is in cargs__flag_info.
 struct cargs_flag {
-    enum cargs_type type; //value of the enum cargs_type
     const char *name;      // name
-    const char *desc;      // short description
-    union cargs_value def; // default value
-    union cargs_value val; // current value
-    void *value_ptr; // pointer to current value (either internal or external)
+    uint32_t hash;         // hash of name, used by the lookup index
+    uint32_t alias_of; // 1 + index of the flag this name stands for, 0 for a flag of its own
+    enum cargs_type type; //value of the enum cargs_type
     bool mandatory; // whether the argument is mandatory (only for positionals)
     bool is_help; // whether this flag triggers help output and skips mandatory validation
+    bool list; // whether every occurrence appends to val.list instead of replacing the value
+};
+
+// the rest of a flag: its value, and what help, snapshots, suggestions and the environment need
+struct cargs__flag_info {
+    union cargs_value val; // current value
+    union cargs_value def; // default value
+    void *value_ptr; // pointer to current value (either internal or external)
+    const char *desc;      // short description
+    const char *env; // environment variable bound with cargs_bind_env(), or NULL
+    const char *alias; // the last alias registered for this flag, for help output
+    char *raw; // in lazy mode, the argument still to be converted, NULL once it was
+};
+
+// a registered subcommand
+struct cargs__command {
+    const char *name;
+    const char *desc;
+    cargs_command_fn setup;
+    void *user;
+};
+
+// Where the parse loop stands between two arguments, so that a stream can be fed to it one chunk at a time.
+struct cargs__parse_state {
+    uint32_t positional;   // positionals are filled in registration order; all before this cursor are assigned
+    bool positionals_only; // whether "--" was seen
+    bool keep;             // whether string arguments are copied, since their buffer is reused
+    cargs_rest_fn rest;    // receives the arguments of a rest positional instead of its list, or NULL
+    void *rest_user;       // passed through to rest
+    uint64_t rest_count;   // number of arguments given to rest
+};
+
+// a string value copied out of the stream buffer; reused by later values of the same flag
+struct cargs__stream_value {
+    char *text;
+    size_t size; // bytes owned by text
+};
+
+// The flag names indexed for suggestions, built on the first one. Flags are listed by name length, and under each
+// trigram of their name; both lists are counting sorts, so flags with equal keys keep registration order. The
+// three bytes of a trigram are hashed to one of nbuckets buckets.
+struct cargs__suggest_index {
+    uint32_t built;      // 1 + ctx->count when built, 0 once it is stale
+    uint32_t query;      // number of the last suggestion
+    uint32_t nbuckets;   // number of trigram buckets, a power of two
+    uint32_t bits;       // log2(nbuckets)
+    void *mem;           // one allocation for the arrays below but grams
+    size_t mem_size;     // bytes owned by mem
+    uint64_t *chars;     // per flag: characters of its name folded to 64 classes
+    uint32_t *length;    // per flag: length of its name
+    uint32_t *seen;      // per flag: number of the last suggestion that compared it
+    uint32_t *by_length; // flags sorted by name length
+    uint32_t *lengths;   // CARGS__SUGGEST_LENGTHS + 1 starts into by_length
+    uint32_t *buckets;   // nbuckets + 1 starts into grams
+    uint32_t *grams;     // flags, once per trigram of their name
+    size_t grams_cap;    // number of slots in grams
 };
 
-#ifndef CARGS_MAX_FLAGS
-#   define CARGS_MAX_FLAGS 128
-#endif // CARGS_MAX_FLAGS
+// a long flag in the sorted abbreviation index
+struct cargs__abbrev {
+    const char *name; // the flag's name
+    uint32_t flag;    // index of the flag
+};
+
+// one value given to a list flag
+struct cargs__list_item {
+    uint32_t flag;         // index of the flag
+    union cargs_value val; // the converted value
+};
+
+// a loaded response file
+struct cargs__rsp_file {
+    char *data;    // contents followed by a terminating zero, split into arguments in place
+    size_t length; // bytes of content, without the terminator
+    size_t size;   // bytes owned by data
+    bool mapped; // whether data is a private mapping rather than an allocation
+};
+
+#ifndef CARGS_CHUNK_FLAGS
+#   define CARGS_CHUNK_FLAGS 16
+#endif // CARGS_CHUNK_FLAGS
+CARGS_STATIC_ASSERT((CARGS_CHUNK_FLAGS & (CARGS_CHUNK_FLAGS - 1)) == 0, "CARGS_CHUNK_FLAGS must be a power of two!");
+
+#ifndef CARGS_RESPONSE_DEPTH
+#   define CARGS_RESPONSE_DEPTH 8
+#endif // CARGS_RESPONSE_DEPTH
+
+// line width of help output that does not go to a terminal
+#ifndef CARGS_HELP_WIDTH
+#   define CARGS_HELP_WIDTH 80
+#endif // CARGS_HELP_WIDTH
+
+// widest names that descriptions in help output are aligned after; longer ones get a line of their own
+#ifndef CARGS_HELP_NAMES
+#   define CARGS_HELP_NAMES 24
+#endif // CARGS_HELP_NAMES
+
+// bytes read from an argument stream at a time; no argument of the stream may be longer
+#ifndef CARGS_STREAM_BUFFER
+#   define CARGS_STREAM_BUFFER (64 * 1024)
+#endif // CARGS_STREAM_BUFFER
+
+// largest edit distance at which a registered flag is suggested for an unknown one
+#ifndef CARGS_SUGGEST_DISTANCE
+#   define CARGS_SUGGEST_DISTANCE 2
+#endif // CARGS_SUGGEST_DISTANCE
+
+// name lengths the suggestion index tells apart; longer names share the last bucket, which no query reaches
+#define CARGS__SUGGEST_LENGTHS (64 + CARGS_SUGGEST_DISTANCE + 2)
+
+#if defined(_WIN32)
+#   include <io.h>
+#   define CARGS__ENVIRON _environ
+#elif defined(__cplusplus)
+extern "C" char **environ;
+#   define CARGS__ENVIRON environ
+#else
+extern char **environ;
+#   define CARGS__ENVIRON environ
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   include <sched.h>
+#   include <sys/ioctl.h>
+#   define CARGS__MMAP 1
+#else
+#   define CARGS__MMAP 0
+#endif
+
+#if CARGS__MMAP && defined(TIOCGWINSZ)
+#   define CARGS__TERMINAL 1
+#else
+#   define CARGS__TERMINAL 0
+#endif
+
+// Instrumentation: counters take a cargs_stats pointer that is NULL where nothing may be counted (batch rows
+// on other threads). Without CARGS_STATS they compile to nothing.
+#ifdef CARGS_STATS
+#   include <time.h>
+#   define CARGS__COUNT(stats, field, n) do { if ((stats) != NULL) (stats)->field += (n); } while (0)
+
+// monotonic nanoseconds where the platform declares a monotonic clock, processor time otherwise
+static uint64_t cargs__now_ns(void)
+{
+#if defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#elif defined(TIME_UTC)
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    return (uint64_t)((double)clock() * (1e9 / CLOCKS_PER_SEC));
+#endif
+}
+#else
+#   define CARGS__COUNT(stats, field, n) ((void)(stats))
+#endif
 
-static struct cargs_flag cargs__flags[CARGS_MAX_FLAGS];
-static uint32_t cargs__count = 0;
-static bool cargs__parsed = false;
-static cargs_error cargs__err = { .error = CARGS_ERROR_NONE, .flag = NULL, .value = NULL };
+// Flags live in chunks that never move, so pointers returned by the registration functions stay valid
+// while the registry grows. Chunk k holds CARGS_CHUNK_FLAGS << k flags, so 32 chunks cover any uint32_t index.
+// Each chunk is a pair of arrays: struct cargs_flag for lookups and struct cargs__flag_info for the rest.
+CARGS_STATIC_ASSERT(CARGS__MAX_CHUNKS == 32, "Chunk table must cover every uint32_t flag index!");
+
+// the context used by the global (non cargs_ctx_*) functions
+static cargs_ctx cargs__default_ctx;
 
 // Forward declarations
-static struct cargs_flag *cargs__new(enum cargs_type type, const char *name, const char *desc);
+static struct cargs__flag_info *cargs__new(cargs_ctx *ctx, enum cargs_type type, const char *name, const char *desc);
 static char * cargs__shift_args(int *argc, char ***argv);
-static void cargs__set_error(enum cargs_errors err, const char *flag, char *value);
-static int cargs__find_next_positional();
+static void cargs__set_error(cargs_error *error, enum cargs_errors err, const char *flag, char *value);
 static int cargs__is_flag(const char *arg);
-static enum cargs_errors cargs__str2int_generic(int64_t *out, char *s, int64_t min, int64_t max);
-static enum cargs_errors cargs__str2uint_generic(uint64_t *out, char *s, uint64_t min, uint64_t max);
-static enum cargs_errors cargs__str2float_generic(long double *out, char *s, long double min, long double max);
+static uint32_t cargs__hash(const char *s);
+static uint32_t cargs__hash_n(const char *s, size_t len);
+static int cargs__lookup(cargs_ctx *ctx, const char *name);
+static int cargs__lookup_counted(cargs_ctx *ctx, const char *name, cargs_stats *stats);
+static int cargs__lookup_n(cargs_ctx *ctx, const char *name, size_t len, cargs_stats *stats);
+static enum cargs_errors cargs__config_bool(const char *value, bool *dst);
+static struct cargs_flag *cargs__flag(cargs_ctx *ctx, uint32_t i);
+static struct cargs__flag_info *cargs__info(cargs_ctx *ctx, uint32_t i);
+static void cargs__grow(cargs_ctx *ctx, uint32_t nflags);
+static void cargs__grow_chunks(cargs_ctx *ctx, uint32_t nflags);
+static void *cargs__alloc(cargs_ctx *ctx, void *ptr, size_t old_size, size_t new_size);
+static size_t cargs__type_size(enum cargs_type type);
+static enum cargs_errors cargs__convert(enum cargs_type type, char *arg, void *dst);
+
+// returns where the value of flag i goes; lets the parse loop fill something other than value_ptr
+typedef void *(*cargs__target_fn)(void *user, uint32_t i);
+static bool cargs__parse_core(cargs_ctx *ctx, int argc, char **argv, cargs__target_fn target, void *user, cargs_stats *stats, cargs_error *err, int *command);
+static int cargs__parse_args(cargs_ctx *ctx, struct cargs__parse_state *state, int argc, char **argv, bool more, cargs__target_fn target, void *user, cargs_stats *stats, cargs_error *err);
+static bool cargs__parse_finish(cargs_ctx *ctx, const struct cargs__parse_state *state, cargs__target_fn target, void *user, cargs_error *err);
+static char *cargs__stream_keep(cargs_ctx *ctx, uint32_t i, const char *arg);
+static bool cargs__help_set(cargs_ctx *ctx, cargs__target_fn target, void *user);
+static bool cargs__lazy_type(enum cargs_type type);
+static bool cargs__lazy_syntax(enum cargs_type type, const char *arg);
+static void cargs__lazy_push(cargs_ctx *ctx, uint32_t i);
+static bool cargs__lazy_convert(cargs_ctx *ctx, uint32_t i);
+static bool cargs__rsp_push(cargs_ctx *ctx, char *arg, bool at, uint32_t depth, bool *expand, cargs_error *err);
+static void cargs__rsp_release(cargs_ctx *ctx);
+static bool cargs__rsp_load(cargs_ctx *ctx, const char *path, struct cargs__rsp_file *file);
+static void cargs__rsp_unload(cargs_ctx *ctx, struct cargs__rsp_file *file);
+static bool cargs__config_apply(cargs_ctx *ctx, const char *path, char *text, cargs__target_fn target, void *user, cargs_error *err);
+static bool cargs__config_error(cargs_error *err, enum cargs_errors code, const char *path, uint32_t line, const char *bol,
+                                const char *at, const char *flag, char *value);
+static bool cargs__is_space(char c);
+static void cargs__list_push(cargs_ctx *ctx, uint32_t i, const union cargs_value *val);
+static void cargs__list_build(cargs_ctx *ctx);
+static void cargs__abbrev_build(cargs_ctx *ctx);
+static int cargs__lookup_prefix(cargs_ctx *ctx, const char *prefix, size_t len, uint32_t *first, cargs_stats *stats);
 
 #define CARGS_REF_IMPL(type_enum, type_name, type_t, field_name) \
-void cargs_##type_name##_ref(const char *name, const char *desc, type_t *ref, type_t def) \
+void cargs_ctx_##type_name##_ref(cargs_ctx *ctx, const char *name, const char *desc, type_t *ref, type_t def) \
 { \
-    struct cargs_flag *flag = cargs__new(type_enum, name, desc); \
-    flag->def.field_name = def; \
+    struct cargs__flag_info *info = cargs__new(ctx, type_enum, name, desc); \
+    info->def.field_name = def; \
     *ref = def; \
-    flag->value_ptr = ref; \
+    info->value_ptr = ref; \
 }
 
 CARGS_REF_IMPL(CARGS_BOOL, bool, bool, boolean)
@@ -312,821 +1125,4245 @@ CARGS_REF_IMPL(CARGS_UINT64, uint64, uint64_t, uint64)
 CARGS_REF_IMPL(CARGS_FLOAT, float, float, floating)
 CARGS_REF_IMPL(CARGS_DOUBLE, double, double, double_val)
 
-void cargs_long_double_ref(const char *name, const char *desc, long double *ref, long double def)
+void cargs_ctx_long_double_ref(cargs_ctx *ctx, const char *name, const char *desc, long double *ref, long double def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_LONG_DOUBLE, name, desc);
-    flag->def.long_double = def;
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_LONG_DOUBLE, name, desc);
+    info->def.long_double = def;
     *ref = def;
-    flag->value_ptr = ref;
+    info->value_ptr = ref;
 }
 
-void cargs_int_ref(const char *name, const char* desc, int *ref, int def)
+void cargs_ctx_int_ref(cargs_ctx *ctx, const char *name, const char* desc, int *ref, int def)
 {
 #if INT_MAX == INT64_MAX
-    cargs_int64_ref(name, desc, (int64_t *)ref, (int64_t)def);
+    cargs_ctx_int64_ref(ctx, name, desc, (int64_t *)ref, (int64_t)def);
 #elif INT_MAX == INT32_MAX
-    cargs_int32_ref(name, desc, (int32_t *)ref, (int32_t)def);
+    cargs_ctx_int32_ref(ctx, name, desc, (int32_t *)ref, (int32_t)def);
 #elif INT_MAX == INT16_MAX
-    cargs_int16_ref(name, desc, (int16_t *)ref, (int16_t)def);
+    cargs_ctx_int16_ref(ctx, name, desc, (int16_t *)ref, (int16_t)def);
 #elif INT_MAX == INT8_MAX
-    cargs_int8_ref(name, desc, (int8_t *)ref, (int8_t)def);
+    cargs_ctx_int8_ref(ctx, name, desc, (int8_t *)ref, (int8_t)def);
 #else
     #error "int size does not match 8/16/32/64 bits"
 #endif
 }
 
-void cargs_size_t_ref(const char *name, const char *desc, size_t *ref, size_t def)
+void cargs_ctx_size_t_ref(cargs_ctx *ctx, const char *name, const char *desc, size_t *ref, size_t def)
 {
 #if SIZE_MAX == UINT64_MAX
-    cargs_uint64_ref(name, desc, (uint64_t *)ref, (uint64_t)def);
+    cargs_ctx_uint64_ref(ctx, name, desc, (uint64_t *)ref, (uint64_t)def);
 #elif SIZE_MAX == UINT32_MAX
-    cargs_uint32_ref(name, desc, (uint32_t *)ref, (uint32_t)def);
+    cargs_ctx_uint32_ref(ctx, name, desc, (uint32_t *)ref, (uint32_t)def);
 #else
     #error "size_t size is neither 32 nor 64 bits"
 #endif
 }
 
-void cargs_string_ref(const char *name, const char* desc, char **ref, const char *def)
+static cargs_list *cargs__new_list(cargs_ctx *ctx, enum cargs_type type, const char *name, const char *desc)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_STRING, name, desc);
-    flag->def.string = (char *)def;
-    *ref = (char *)def;
-    flag->value_ptr = ref;
+    struct cargs__flag_info *info = cargs__new(ctx, type, name, desc);
+    cargs__flag(ctx, ctx->count - 1)->list = true;
+    return &info->val.list;
+}
+
+#define CARGS_LIST_IMPL(type_enum, type_name) \
+cargs_list * cargs_ctx_##type_name##_list(cargs_ctx *ctx, const char *name, const char *desc) \
+{ \
+    return cargs__new_list(ctx, type_enum, name, desc); \
 }
 
+CARGS_LIST_IMPL(CARGS_BOOL, bool)
+CARGS_LIST_IMPL(CARGS_CHAR, char)
+CARGS_LIST_IMPL(CARGS_INT8, int8)
+CARGS_LIST_IMPL(CARGS_UINT8, uint8)
+CARGS_LIST_IMPL(CARGS_INT16, int16)
+CARGS_LIST_IMPL(CARGS_UINT16, uint16)
+CARGS_LIST_IMPL(CARGS_INT32, int32)
+CARGS_LIST_IMPL(CARGS_UINT32, uint32)
+CARGS_LIST_IMPL(CARGS_INT64, int64)
+CARGS_LIST_IMPL(CARGS_UINT64, uint64)
+CARGS_LIST_IMPL(CARGS_FLOAT, float)
+CARGS_LIST_IMPL(CARGS_DOUBLE, double)
+CARGS_LIST_IMPL(CARGS_LONG_DOUBLE, long_double)
+CARGS_LIST_IMPL(CARGS_STRING, string)
+
+cargs_list * cargs_ctx_int_list(cargs_ctx *ctx, const char *name, const char *desc)
+{
+#if INT_MAX == INT64_MAX
+    return cargs_ctx_int64_list(ctx, name, desc);
+#elif INT_MAX == INT32_MAX
+    return cargs_ctx_int32_list(ctx, name, desc);
+#elif INT_MAX == INT16_MAX
+    return cargs_ctx_int16_list(ctx, name, desc);
+#elif INT_MAX == INT8_MAX
+    return cargs_ctx_int8_list(ctx, name, desc);
+#else
+    #error "int size does not match 8/16/32/64 bits"
+#endif
+}
 
+cargs_list * cargs_ctx_size_t_list(cargs_ctx *ctx, const char *name, const char *desc)
+{
+#if SIZE_MAX == UINT64_MAX
+    return cargs_ctx_uint64_list(ctx, name, desc);
+#elif SIZE_MAX == UINT32_MAX
+    return cargs_ctx_uint32_list(ctx, name, desc);
+#else
+    #error "size_t size is neither 32 nor 64 bits"
+#endif
+}
 
-// forward declaration of helper functions
+void cargs_ctx_string_ref(cargs_ctx *ctx, const char *name, const char* desc, char **ref, const char *def)
+{
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_STRING, name, desc);
+    info->def.string = (char *)def;
+    *ref = (char *)def;
+    info->value_ptr = ref;
+}
 
-static struct cargs_flag *cargs__new(enum cargs_type type, const char *name, const char *desc);
-static char * cargs__shift_args(int *argc, char ***argv);
-static void cargs__set_error(enum cargs_errors err, const char *flag, char *value);
 
 
-bool * cargs_bool(const char *name, const char *desc, bool def)
+bool * cargs_ctx_bool(cargs_ctx *ctx, const char *name, const char *desc, bool def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_BOOL, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_BOOL, name, desc);
 
-    flag->def.boolean = def;
-    flag->val.boolean = def;
+    info->def.boolean = def;
+    info->val.boolean = def;
 
-    return (bool *)flag->value_ptr;
+    return (bool *)info->value_ptr;
 }
 
-char * cargs_char(const char *name, const char *desc, char def)
+char * cargs_ctx_char(cargs_ctx *ctx, const char *name, const char *desc, char def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_CHAR, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_CHAR, name, desc);
 
-    flag->def.character = def;
-    flag->val.character = def;
+    info->def.character = def;
+    info->val.character = def;
 
-    return (char *)flag->value_ptr;
+    return (char *)info->value_ptr;
 }
 
-int8_t * cargs_int8(const char *name, const char *desc, int8_t def)
+int8_t * cargs_ctx_int8(cargs_ctx *ctx, const char *name, const char *desc, int8_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_INT8, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_INT8, name, desc);
 
-    flag->def.int8 = def;
-    flag->val.int8 = def;
+    info->def.int8 = def;
+    info->val.int8 = def;
 
-    return (int8_t *)flag->value_ptr;
+    return (int8_t *)info->value_ptr;
 }
 
-uint8_t * cargs_uint8(const char *name, const char *desc, uint8_t def)
+uint8_t * cargs_ctx_uint8(cargs_ctx *ctx, const char *name, const char *desc, uint8_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_UINT8, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_UINT8, name, desc);
 
-    flag->def.uint8 = def;
-    flag->val.uint8 = def;
+    info->def.uint8 = def;
+    info->val.uint8 = def;
 
-    return (uint8_t *)flag->value_ptr;
+    return (uint8_t *)info->value_ptr;
 }
 
-int16_t * cargs_int16(const char *name, const char *desc, int16_t def)
+int16_t * cargs_ctx_int16(cargs_ctx *ctx, const char *name, const char *desc, int16_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_INT16, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_INT16, name, desc);
 
-    flag->def.int16 = def;
-    flag->val.int16 = def;
+    info->def.int16 = def;
+    info->val.int16 = def;
 
-    return (int16_t *)flag->value_ptr;
+    return (int16_t *)info->value_ptr;
 }
 
-uint16_t * cargs_uint16(const char *name, const char *desc, uint16_t def)
+uint16_t * cargs_ctx_uint16(cargs_ctx *ctx, const char *name, const char *desc, uint16_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_UINT16, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_UINT16, name, desc);
 
-    flag->def.uint16 = def;
-    flag->val.uint16 = def;
+    info->def.uint16 = def;
+    info->val.uint16 = def;
 
-    return (uint16_t *)flag->value_ptr;
+    return (uint16_t *)info->value_ptr;
 }
 
-int32_t * cargs_int32(const char *name, const char *desc, int32_t def)
+int32_t * cargs_ctx_int32(cargs_ctx *ctx, const char *name, const char *desc, int32_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_INT32, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_INT32, name, desc);
 
-    flag->def.int32 = def;
-    flag->val.int32 = def;
+    info->def.int32 = def;
+    info->val.int32 = def;
 
-    return (int32_t *)flag->value_ptr;
+    return (int32_t *)info->value_ptr;
 }
 
-uint32_t * cargs_uint32(const char *name, const char *desc, uint32_t def)
+uint32_t * cargs_ctx_uint32(cargs_ctx *ctx, const char *name, const char *desc, uint32_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_UINT32, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_UINT32, name, desc);
 
-    flag->def.uint32 = def;
-    flag->val.uint32 = def;
+    info->def.uint32 = def;
+    info->val.uint32 = def;
 
-    return (uint32_t *)flag->value_ptr;
+    return (uint32_t *)info->value_ptr;
 }
 
-int64_t * cargs_int64(const char *name, const char *desc, int64_t def)
+int64_t * cargs_ctx_int64(cargs_ctx *ctx, const char *name, const char *desc, int64_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_INT64, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_INT64, name, desc);
 
-    flag->def.int64 = def;
-    flag->val.int64 = def;
+    info->def.int64 = def;
+    info->val.int64 = def;
 
-    return (int64_t *)flag->value_ptr;
+    return (int64_t *)info->value_ptr;
 }
 
-uint64_t * cargs_uint64(const char *name, const char *desc, uint64_t def)
+uint64_t * cargs_ctx_uint64(cargs_ctx *ctx, const char *name, const char *desc, uint64_t def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_UINT64, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_UINT64, name, desc);
 
-    flag->def.uint64 = def;
-    flag->val.uint64 = def;
+    info->def.uint64 = def;
+    info->val.uint64 = def;
 
-    return (uint64_t *)flag->value_ptr;
+    return (uint64_t *)info->value_ptr;
 }
 
-int * cargs_int(const char *name, const char* desc, int def)
+int * cargs_ctx_int(cargs_ctx *ctx, const char *name, const char* desc, int def)
 {
 #if INT_MAX == INT64_MAX
-    return (int *)cargs_int64(name, desc, (int64_t)def);
+    return (int *)cargs_ctx_int64(ctx, name, desc, (int64_t)def);
 #elif INT_MAX == INT32_MAX
-    return (int *)cargs_int32(name, desc, (int32_t)def);
+    return (int *)cargs_ctx_int32(ctx, name, desc, (int32_t)def);
 #elif INT_MAX == INT16_MAX
-    return (int *)cargs_int16(name, desc, (int16_t)def);
+    return (int *)cargs_ctx_int16(ctx, name, desc, (int16_t)def);
 #elif INT_MAX == INT8_MAX
-    return (int *)cargs_int8(name, desc, (int8_t)def);
+    return (int *)cargs_ctx_int8(ctx, name, desc, (int8_t)def);
 #else
     #error "int size does not match 8/16/32/64 bits"
 #endif
 }
 
-size_t * cargs_size_t(const char *name, const char *desc, size_t def)
+size_t * cargs_ctx_size_t(cargs_ctx *ctx, const char *name, const char *desc, size_t def)
 {
 #if SIZE_MAX == UINT64_MAX
-    return (size_t *)cargs_uint64(name, desc, (uint64_t)def);
+    return (size_t *)cargs_ctx_uint64(ctx, name, desc, (uint64_t)def);
 #elif SIZE_MAX == UINT32_MAX
-    return (size_t *)cargs_uint32(name, desc, (uint32_t)def);
+    return (size_t *)cargs_ctx_uint32(ctx, name, desc, (uint32_t)def);
 #else
     #error "size_t size is neither 32 nor 64 bits"
 #endif
 }
 
-float * cargs_float(const char *name, const char* desc, float def)
+float * cargs_ctx_float(cargs_ctx *ctx, const char *name, const char* desc, float def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_FLOAT, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_FLOAT, name, desc);
 
-    flag->def.floating = def;
-    flag->val.floating = def;
+    info->def.floating = def;
+    info->val.floating = def;
 
-    return (float *)flag->value_ptr;
+    return (float *)info->value_ptr;
 }
 
-double * cargs_double(const char *name, const char* desc, double def)
+double * cargs_ctx_double(cargs_ctx *ctx, const char *name, const char* desc, double def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_DOUBLE, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_DOUBLE, name, desc);
 
-    flag->def.double_val = def;
-    flag->val.double_val = def;
+    info->def.double_val = def;
+    info->val.double_val = def;
 
-    return (double *)flag->value_ptr;
+    return (double *)info->value_ptr;
 }
 
-long double * cargs_long_double(const char *name, const char* desc, long double def)
+long double * cargs_ctx_long_double(cargs_ctx *ctx, const char *name, const char* desc, long double def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_LONG_DOUBLE, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_LONG_DOUBLE, name, desc);
 
-    flag->def.long_double = def;
-    flag->val.long_double = def;
+    info->def.long_double = def;
+    info->val.long_double = def;
 
-    return (long double *)flag->value_ptr;
+    return (long double *)info->value_ptr;
 }
 
-char ** cargs_string(const char *name, const char* desc, const char *def)
+char ** cargs_ctx_string(cargs_ctx *ctx, const char *name, const char* desc, const char *def)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_STRING, name, desc);
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_STRING, name, desc);
 
-    flag->def.string = (char*) def;
-    flag->val.string = (char*) def;
+    info->def.string = (char*) def;
+    info->val.string = (char*) def;
 
-    return (char **)flag->value_ptr;
+    return (char **)info->value_ptr;
 }
 
-char ** cargs_positional(const char *name, const char *desc, bool mandatory)
+char ** cargs_ctx_positional(cargs_ctx *ctx, const char *name, const char *desc, bool mandatory)
+{
+    assert(ctx->ncommands == 0 && "cargs_positional: a program with subcommands takes no positionals");
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_POSITIONAL, name, desc);
+
+    cargs__flag(ctx, ctx->count - 1)->mandatory = mandatory;
+    info->val.string = NULL;
+    info->value_ptr = &info->val.string;
+
+    return (char **)info->value_ptr;
+}
+
+cargs_list * cargs_ctx_rest(cargs_ctx *ctx, const char *name, const char *desc, bool mandatory)
 {
-    struct cargs_flag *flag = cargs__new(CARGS_POSITIONAL, name, desc);
+    assert(ctx->ncommands == 0 && "cargs_rest: a program with subcommands takes no positionals");
+    struct cargs__flag_info *info = cargs__new(ctx, CARGS_POSITIONAL, name, desc);
+    struct cargs_flag *flag = cargs__flag(ctx, ctx->count - 1);
 
     flag->mandatory = mandatory;
-    flag->val.string = NULL;
-    flag->value_ptr = &flag->val.string;
+    flag->list = true;
+    return &info->val.list;
+}
+
+void cargs_ctx_alias(cargs_ctx *ctx, const char *alias, const char *name)
+{
+    int i = cargs__lookup(ctx, name);
+    assert(i != -1 && cargs__flag(ctx, i)->type != CARGS_POSITIONAL && "cargs_alias: no flag with that name");
+
+    // the alias gets a record of its own in the index; lookups resolve it to the flag
+    struct cargs__flag_info *info = cargs__new(ctx, cargs__flag(ctx, i)->type, alias, cargs__info(ctx, i)->desc);
+    struct cargs__flag_info *target = cargs__info(ctx, i);
+    cargs__flag(ctx, ctx->count - 1)->alias_of = (uint32_t)i + 1;
+    info->value_ptr = target->value_ptr;
+    target->alias = alias;
+}
 
-    return (char **)flag->value_ptr;
+void cargs_ctx_init(cargs_ctx *ctx)
+{
+    memset(ctx, 0, sizeof(*ctx));
 }
 
-void cargs_mark_help(const char *name)
+void cargs_ctx_set_allocator(cargs_ctx *ctx, cargs_alloc_fn fn, void *user)
 {
-    for (uint32_t i = 0; i < cargs__count; ++i) {
-        if (strcmp(cargs__flags[i].name, name) == 0) {
-            cargs__flags[i].is_help = true;
-            return;
-        }
+    assert(ctx->nchunks == 0 && ctx->index == NULL && ctx->rsp_argv == NULL && ctx->list_items == NULL && ctx->commands == NULL && ctx->pending == NULL && ctx->help_text == NULL && ctx->stream_buf == NULL && "cargs_set_allocator: call it before registering flags or after cargs_free()");
+    ctx->alloc_fn = fn;
+    ctx->alloc_user = user;
+}
+
+void cargs_ctx_reserve(cargs_ctx *ctx, uint32_t nflags)
+{
+    cargs__grow(ctx, nflags);
+}
+
+void cargs_ctx_free(cargs_ctx *ctx)
+{
+    cargs_ctx_reset(ctx);
+    for (uint32_t k = 0; k < ctx->nchunks; ++k) {
+        size_t n = (size_t)CARGS_CHUNK_FLAGS << k;
+        cargs__alloc(ctx, ctx->chunks[k], n * sizeof(struct cargs_flag), 0);
+        cargs__alloc(ctx, ctx->infos[k], n * sizeof(struct cargs__flag_info), 0);
+        ctx->chunks[k] = NULL;
+        ctx->infos[k] = NULL;
     }
-    assert(0 && "cargs_mark_help: flag name not found — register the flag before marking it as help");
+    if (ctx->index != NULL) cargs__alloc(ctx, ctx->index, ctx->index_cap * sizeof(*ctx->index), 0);
+    ctx->index = NULL;
+    ctx->index_cap = 0;
+    ctx->nchunks = 0;
+    ctx->capacity = 0;
+    if (ctx->rsp_argv != NULL) cargs__alloc(ctx, ctx->rsp_argv, ctx->rsp_argv_cap * sizeof(*ctx->rsp_argv), 0);
+    if (ctx->rsp_files != NULL) cargs__alloc(ctx, ctx->rsp_files, ctx->rsp_files_cap * sizeof(*ctx->rsp_files), 0);
+    ctx->rsp_argv = NULL;
+    ctx->rsp_argv_cap = 0;
+    ctx->rsp_files = NULL;
+    ctx->rsp_files_cap = 0;
+    if (ctx->list_items != NULL) cargs__alloc(ctx, ctx->list_items, ctx->list_items_cap * sizeof(*ctx->list_items), 0);
+    if (ctx->list_arena != NULL) cargs__alloc(ctx, ctx->list_arena, ctx->list_arena_size, 0);
+    ctx->list_items = NULL;
+    ctx->list_items_cap = 0;
+    ctx->list_arena = NULL;
+    ctx->list_arena_size = 0;
+    if (ctx->abbrev_names != NULL) cargs__alloc(ctx, ctx->abbrev_names, ctx->abbrev_cap * sizeof(*ctx->abbrev_names), 0);
+    if (ctx->err_text != NULL) cargs__alloc(ctx, ctx->err_text, ctx->err_text_size, 0);
+    ctx->abbrev_names = NULL;
+    ctx->abbrev_cap = 0;
+    ctx->err_text = NULL;
+    ctx->err_text_size = 0;
+    if (ctx->suggest != NULL) {
+        cargs__alloc(ctx, ctx->suggest->mem, ctx->suggest->mem_size, 0);
+        cargs__alloc(ctx, ctx->suggest->grams, ctx->suggest->grams_cap * sizeof(uint32_t), 0);
+        cargs__alloc(ctx, ctx->suggest, sizeof(*ctx->suggest), 0);
+        ctx->suggest = NULL;
+    }
+    if (ctx->commands != NULL) cargs__alloc(ctx, ctx->commands, ctx->commands_cap * sizeof(*ctx->commands), 0);
+    ctx->commands = NULL;
+    ctx->commands_cap = 0;
+    if (ctx->pending != NULL) cargs__alloc(ctx, ctx->pending, ctx->pending_cap * sizeof(*ctx->pending), 0);
+    ctx->pending = NULL;
+    ctx->pending_cap = 0;
+    if (ctx->help_text != NULL) cargs__alloc(ctx, ctx->help_text, ctx->help_size, 0);
+    ctx->help_text = NULL;
+    ctx->help_size = 0;
+    if (ctx->stream_buf != NULL) cargs__alloc(ctx, ctx->stream_buf, CARGS_STREAM_BUFFER + 1, 0);
+    ctx->stream_buf = NULL;
+    if (ctx->stream_held != NULL) cargs__alloc(ctx, ctx->stream_held, ctx->stream_held_size, 0);
+    ctx->stream_held = NULL;
+    ctx->stream_held_size = 0;
 }
 
-bool cargs_parse(int argc, char **argv)
+void *cargs_arena_alloc(void *user, void *ptr, size_t old_size, size_t new_size)
 {
-    if (cargs__parsed) {
-        cargs__set_error(CARGS_ERROR_UNKNOWN, "cargs_parse", NULL);
-        return false;
+    cargs_arena *arena = (cargs_arena *)user;
+    const size_t align = 16;
+
+    // only the most recent allocation can be shrunk, grown or released in place
+    bool last = ptr != NULL && (char *)ptr + old_size == arena->base + arena->used;
+
+    if (new_size == 0) {
+        if (last) arena->used -= old_size;
+        return NULL;
     }
-    cargs__parsed = true;
 
-    // Remove first entry which is the program's name
-    cargs__shift_args(&argc, &argv);
+    if (last && (size_t)((char *)ptr - arena->base) + new_size <= arena->size) {
+        arena->used = (size_t)((char *)ptr - arena->base) + new_size;
+        return ptr;
+    }
 
-    while (argc > 0) {
-        char *flag_name = cargs__shift_args(&argc, &argv);
+    size_t offset = (arena->used + align - 1) & ~(align - 1);
+    if (offset > arena->size || new_size > arena->size - offset) return NULL;
 
-        // "--" sentinel: treat all remaining args as positionals
-        if (strcmp(flag_name, "--") == 0) {
-            while (argc > 0) {
-                char *pos = cargs__shift_args(&argc, &argv);
-                int pos_idx = cargs__find_next_positional();
-                if (pos_idx == -1) {
-                    cargs__set_error(CARGS_ERROR_UNKNOWN, pos, NULL);
-                    return false;
-                }
-                cargs__flags[pos_idx].val.string = pos;
-                *(char **)(cargs__flags[pos_idx].value_ptr) = pos;
-            }
-            break;
-        }
+    char *res = arena->base + offset;
+    arena->used = offset + new_size;
+    if (ptr != NULL) memcpy(res, ptr, old_size < new_size ? old_size : new_size);
+    return res;
+}
 
-        uint32_t i;
-        for (i = 0; i < cargs__count; ++i) {
-            // check if flag_name matches any of the declared flags
-            if (strcmp(cargs__flags[i].name, flag_name) == 0) {
-                // check type of flag and parse accordingly
-                switch (cargs__flags[i].type) {
-                    case CARGS_BOOL: {
-                        *(bool *)(cargs__flags[i].value_ptr) = true;
-                    }
-                    break;
+void cargs_ctx_mark_help(cargs_ctx *ctx, const char *name)
+{
+    int i = cargs__lookup(ctx, name);
+    if (i != -1) {
+        cargs__flag(ctx, i)->is_help = true;
+        return;
+    }
+    assert(0 && "cargs_mark_help: flag name not found — register the flag before marking it as help");
+}
 
-                    case CARGS_CHAR: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        // silently taking arg[0] would swallow typos like --flag "ab"
-                        if (arg[1] != '\0') {
-                            cargs__set_error(CARGS_ERROR_INVALID_NUMBER, flag_name, arg);
-                            return false;
-                        }
-                        *(char *)(cargs__flags[i].value_ptr) = arg[0];
-                    }
-                    break;
+void cargs_ctx_allow_abbrev(cargs_ctx *ctx, bool enable)
+{
+    ctx->abbrev = enable;
+}
 
-                    case CARGS_INT8: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        int64_t val;
-                        enum cargs_errors res = cargs__str2int_generic(&val, arg, INT8_MIN, INT8_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(int8_t *)(cargs__flags[i].value_ptr) = (int8_t)val;
-                    }
-                    break;
+void cargs_ctx_command(cargs_ctx *ctx, const char *name, const char *desc, cargs_command_fn setup, void *user)
+{
+    assert(!ctx->parsed && "Subcommand registered after cargs_parse() was called — register all subcommands before parsing!");
+    assert(setup != NULL && !cargs__is_flag(name) && "cargs_command: a subcommand needs a setup function and a name that is no flag");
+    for (uint32_t i = 0; ctx->ncommands == 0 && i < ctx->count; ++i) {
+        assert(cargs__flag(ctx, i)->type != CARGS_POSITIONAL && "cargs_command: a program with subcommands takes no positionals");
+    }
+    for (uint32_t k = 0; k < ctx->ncommands; ++k) {
+        assert(strcmp(ctx->commands[k].name, name) != 0 && "Duplicate subcommand name!");
+    }
 
-                    case CARGS_INT16: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        int64_t val;
-                        enum cargs_errors res = cargs__str2int_generic(&val, arg, INT16_MIN, INT16_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(int16_t *)(cargs__flags[i].value_ptr) = (int16_t)val;
-                    }
-                    break;
+    if (ctx->ncommands == ctx->commands_cap) {
+        uint32_t cap = ctx->commands_cap ? ctx->commands_cap * 2 : 8;
+        ctx->commands = (struct cargs__command *)cargs__alloc(ctx, ctx->commands, ctx->commands_cap * sizeof(*ctx->commands), cap * sizeof(*ctx->commands));
+        ctx->commands_cap = cap;
+    }
+    struct cargs__command *command = &ctx->commands[ctx->ncommands++];
+    command->name = name;
+    command->desc = desc;
+    command->setup = setup;
+    command->user = user;
+}
 
-                    case CARGS_INT32: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        int64_t val;
-                        enum cargs_errors res = cargs__str2int_generic(&val, arg, INT32_MIN, INT32_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(int32_t *)(cargs__flags[i].value_ptr) = (int32_t)val;
-                    }
-                    break;
+const char *cargs_ctx_selected_command(cargs_ctx *ctx)
+{
+    return ctx->command != 0 ? ctx->commands[ctx->command - 1].name : NULL;
+}
 
-                    case CARGS_INT64: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        int64_t val;
-                        enum cargs_errors res = cargs__str2int_generic(&val, arg, INT64_MIN, INT64_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(int64_t *)(cargs__flags[i].value_ptr) = val;
-                    }
-                    break;
+cargs_ctx *cargs_ctx_command_ctx(cargs_ctx *ctx)
+{
+    return ctx->command_ctx;
+}
 
-                    case CARGS_UINT8: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        uint64_t val;
-                        enum cargs_errors res = cargs__str2uint_generic(&val, arg, 0, UINT8_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(uint8_t *)(cargs__flags[i].value_ptr) = (uint8_t)val;
-                    }
-                    break;
+// writes the n names comma-separated to err_text, followed by ", ..." if more were left out
+static char *cargs__err_names(cargs_ctx *ctx, const char *const *names, uint32_t n, bool more)
+{
+    size_t size = 8;
+    for (uint32_t k = 0; k < n; ++k) size += strlen(names[k]) + 2;
+    if (size > ctx->err_text_size) {
+        if (ctx->err_text != NULL) cargs__alloc(ctx, ctx->err_text, ctx->err_text_size, 0);
+        ctx->err_text = (char *)cargs__alloc(ctx, NULL, 0, size);
+        ctx->err_text_size = size;
+    }
+    char *w = ctx->err_text;
+    for (uint32_t k = 0; k < n; ++k) {
+        if (k > 0) {
+            memcpy(w, ", ", 2);
+            w += 2;
+        }
+        size_t len = strlen(names[k]);
+        memcpy(w, names[k], len);
+        w += len;
+    }
+    if (more) {
+        memcpy(w, ", ...", 5);
+        w += 5;
+    }
+    *w = '\0';
+    return ctx->err_text;
+}
 
-                    case CARGS_UINT16: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        uint64_t val;
-                        enum cargs_errors res = cargs__str2uint_generic(&val, arg, 0, UINT16_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(uint16_t *)(cargs__flags[i].value_ptr) = (uint16_t)val;
-                    }
-                    break;
+// Lists the flags starting with prefix. Only the first few are named, since a short prefix can match thousands
+// of flags.
+static char *cargs__abbrev_candidates(cargs_ctx *ctx, const char *prefix)
+{
+    const char *names[8];
+    uint32_t first, n = 0;
+    size_t len = strcspn(prefix, "="); // --prefix=value
+    cargs__lookup_prefix(ctx, prefix, len, &first, NULL);
+
+    uint32_t end = first;
+    while (end < ctx->abbrev_count && strncmp(ctx->abbrev_names[end].name, prefix, len) == 0) {
+        if (n < 8) names[n++] = ctx->abbrev_names[end].name;
+        end++;
+    }
+    return cargs__err_names(ctx, names, n, end - first > n);
+}
 
-                    case CARGS_UINT32: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        uint64_t val;
-                        enum cargs_errors res = cargs__str2uint_generic(&val, arg, 0, UINT32_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(uint32_t *)(cargs__flags[i].value_ptr) = (uint32_t)val;
-                    }
-                    break;
+static uint32_t cargs__popcount(uint64_t v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (uint32_t)__builtin_popcountll(v);
+#else
+    uint32_t n = 0;
+    for (; v != 0; v &= v - 1) n++;
+    return n;
+#endif
+}
 
-                    case CARGS_UINT64: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        uint64_t val;
-                        enum cargs_errors res = cargs__str2uint_generic(&val, arg, 0, UINT64_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(uint64_t *)(cargs__flags[i].value_ptr) = val;
-                    }
-                    break;
+// Levenshtein distance between a pattern of m <= 64 characters, given as one bit mask per character (peq), and
+// the n characters of s. Myers' bit-parallel algorithm keeps a whole column of the distance matrix in two words,
+// so each character of s costs a handful of word operations. Stops early once the distance must exceed k.
+static uint32_t cargs__edit_distance(const uint64_t *peq, uint32_t m, const char *s, uint32_t n, uint32_t k)
+{
+    const uint64_t last = (uint64_t)1 << (m - 1);
+    uint64_t pv = m == 64 ? ~(uint64_t)0 : ((uint64_t)1 << m) - 1;
+    uint64_t mv = 0;
+    uint32_t score = m;
+    for (uint32_t j = 0; j < n; ++j) {
+        uint64_t eq = peq[(unsigned char)s[j]];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) score++;
+        else if (mh & last) score--;
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+        // each remaining character lowers the distance by at most one
+        if (score > k + (n - j - 1)) return k + 1;
+    }
+    return score;
+}
 
-                    case CARGS_SIZE_T: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        uint64_t val;
-                        enum cargs_errors res = cargs__str2uint_generic(&val, arg, 0, SIZE_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(size_t *)(cargs__flags[i].value_ptr) = (size_t)val;
-                    }
-                    break;
+// the closest names found so far, sorted by distance, then by registration order
+struct cargs__suggestions {
+    const char *names[3];
+    uint32_t dists[3];
+    uint32_t order[3];
+    uint32_t n;
+};
 
-                    case CARGS_FLOAT: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        long double val;
-                        enum cargs_errors res = cargs__str2float_generic(&val, arg, -FLT_MAX, FLT_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        // long double -> float narrowing can produce ±Inf even within ±FLT_MAX range
-                        float narrowed = (float)val;
-                        if (!isfinite(narrowed)) {
-                            cargs__set_error(CARGS_ERROR_OVERFLOW, flag_name, arg);
-                            return false;
-                        }
-                        *(float *)(cargs__flags[i].value_ptr) = narrowed;
-                    }
-                    break;
+// keeps name if it is within k edits and among the three closest
+static void cargs__suggest_add(struct cargs__suggestions *s, const char *name, uint32_t d, uint32_t order, uint32_t k)
+{
+    if (d > k || (s->n == 3 && (d > s->dists[2] || (d == s->dists[2] && order > s->order[2])))) return;
+    uint32_t at = s->n < 3 ? s->n++ : 2;
+    while (at > 0 && (s->dists[at - 1] > d || (s->dists[at - 1] == d && s->order[at - 1] > order))) {
+        s->names[at] = s->names[at - 1];
+        s->dists[at] = s->dists[at - 1];
+        s->order[at] = s->order[at - 1];
+        at--;
+    }
+    s->names[at] = name;
+    s->dists[at] = d;
+    s->order[at] = order;
+}
 
-                    case CARGS_DOUBLE: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        long double val;
-                        enum cargs_errors res = cargs__str2float_generic(&val, arg, -DBL_MAX, DBL_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(double *)(cargs__flags[i].value_ptr) = (double)val;
-                    }
-                    break;
+// bucket of the trigram in the low 24 bits of key
+static uint32_t cargs__gram_bucket(uint32_t key, uint32_t bits)
+{
+    return (uint32_t)(((key & 0xffffffu) * 2654435761u) >> (32 - bits));
+}
 
-                    case CARGS_LONG_DOUBLE: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        long double val;
-                        enum cargs_errors res = cargs__str2float_generic(&val, arg, -LDBL_MAX, LDBL_MAX);
-                        if (res != CARGS_ERROR_NONE) {
-                            cargs__set_error(res, flag_name, arg);
-                            return false;
-                        }
-                        *(long double *)(cargs__flags[i].value_ptr) = val;
-                    }
-                    break;
+static void cargs__suggest_build(cargs_ctx *ctx)
+{
+    const uint32_t nlengths = CARGS__SUGGEST_LENGTHS;
+    uint32_t count = ctx->count;
+    if (ctx->suggest == NULL) {
+        ctx->suggest = (struct cargs__suggest_index *)cargs__alloc(ctx, NULL, 0, sizeof(*ctx->suggest));
+        memset(ctx->suggest, 0, sizeof(*ctx->suggest));
+    }
+    struct cargs__suggest_index *x = ctx->suggest;
+    // a bucket for every two names, at most 2^18
+    uint32_t bits = 6;
+    while (bits < 18 && ((uint32_t)1 << bits) < count / 2) bits++;
+    uint32_t nbuckets = (uint32_t)1 << bits;
+
+    size_t size = (size_t)count * (sizeof(uint64_t) + 3 * sizeof(uint32_t)) + ((size_t)nlengths + 1 + nbuckets + 1) * sizeof(uint32_t);
+    if (size > x->mem_size) {
+        if (x->mem != NULL) cargs__alloc(ctx, x->mem, x->mem_size, 0);
+        x->mem = cargs__alloc(ctx, NULL, 0, size);
+        x->mem_size = size;
+    }
+    x->chars = (uint64_t *)x->mem;
+    x->length = (uint32_t *)(x->chars + count);
+    x->seen = x->length + count;
+    x->by_length = x->seen + count;
+    x->lengths = x->by_length + count;
+    x->buckets = x->lengths + nlengths + 1;
+    memset(x->seen, 0, count * sizeof(uint32_t));
+    memset(x->lengths, 0, (nlengths + 1 + nbuckets + 1) * sizeof(uint32_t));
+
+    // count, turn the counts into starts, then place each flag at the start of its key and advance it
+    size_t ngrams = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->type == CARGS_POSITIONAL) continue;
+        uint32_t key = 0, len = 0;
+        uint64_t chars = 0;
+        for (const char *c = flag->name; *c != '\0'; ++c, ++len) {
+            chars |= (uint64_t)1 << (*c & 63);
+            key = key << 8 | (unsigned char)*c;
+            if (len >= 2) x->buckets[cargs__gram_bucket(key, bits) + 1]++;
+        }
+        x->chars[i] = chars;
+        x->length[i] = len;
+        x->lengths[(len < nlengths ? len : nlengths - 1) + 1]++;
+        if (len >= 3) ngrams += len - 2;
+    }
+    if (ngrams > x->grams_cap) {
+        if (x->grams != NULL) cargs__alloc(ctx, x->grams, x->grams_cap * sizeof(uint32_t), 0);
+        x->grams = (uint32_t *)cargs__alloc(ctx, NULL, 0, ngrams * sizeof(uint32_t));
+        x->grams_cap = ngrams;
+    }
+    for (uint32_t l = 0; l < nlengths; ++l) x->lengths[l + 1] += x->lengths[l];
+    for (uint32_t b = 0; b < nbuckets; ++b) x->buckets[b + 1] += x->buckets[b];
+    for (uint32_t i = 0; i < count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->type == CARGS_POSITIONAL) continue;
+        uint32_t len = x->length[i], key = 0;
+        x->by_length[x->lengths[len < nlengths ? len : nlengths - 1]++] = i;
+        for (uint32_t j = 0; j < len; ++j) {
+            key = key << 8 | (unsigned char)flag->name[j];
+            if (j >= 2) x->grams[x->buckets[cargs__gram_bucket(key, bits)]++] = i;
+        }
+    }
+    // each start was advanced to the next one
+    memmove(x->lengths + 1, x->lengths, nlengths * sizeof(uint32_t));
+    x->lengths[0] = 0;
+    memmove(x->buckets + 1, x->buckets, nbuckets * sizeof(uint32_t));
+    x->buckets[0] = 0;
+
+    x->built = count + 1;
+    x->query = 0;
+    x->nbuckets = nbuckets;
+    x->bits = bits;
+}
 
-                    case CARGS_STRING: {
-                        if (argc == 0 || cargs__is_flag(*argv)) {
-                            cargs__set_error(CARGS_ERROR_NO_VALUE, flag_name, NULL);
-                            return false;
-                        }
-                        char *arg = cargs__shift_args(&argc, &argv);
-                        *(char **)(cargs__flags[i].value_ptr) = arg;
-                    }
-                    break;
+// compares flag i with the unknown name, unless this suggestion did already
+static void cargs__suggest_flag(cargs_ctx *ctx, struct cargs__suggestions *s, const uint64_t *peq, uint32_t m, uint64_t chars, uint32_t i, uint32_t k)
+{
+    struct cargs__suggest_index *x = ctx->suggest;
+    if (x->seen[i] == x->query) return;
+    x->seen[i] = x->query;
+    // cheap bounds first: every edit changes the length by at most one and brings in or removes at most one
+    // kind of character, so more than k characters (folded to 64 classes) missing on either side rule it out
+    uint32_t len = x->length[i];
+    if (len > m + k || m > len + k) return;
+    if (cargs__popcount(chars & ~x->chars[i]) > k || cargs__popcount(x->chars[i] & ~chars) > k) return;
+    const char *name = cargs__flag(ctx, i)->name;
+    cargs__suggest_add(s, name, cargs__edit_distance(peq, m, name, len, k), i, k);
+}
 
-                    case CARGS_TYPE_COUNT:
-                    default: {
-                        assert(0 && "Unreachable, Unknown Type");
-                    }
-                }
-                // exit loop if we successfully parsed the flag
-                break;
-            }
+// Names the registered flags closest to an unknown one: up to three within CARGS_SUGGEST_DISTANCE edits, but
+// fewer edits than the name has characters after its dashes, so "-x" does not suggest every short flag.
+//
+// Only a few flags are compared, taken from the index built on first use. A flag within k edits has a length
+// within k of the name's. An edit changes at most one of the name's trigrams that do not overlap, so the flag also
+// contains one of any k + 1 of those. The search takes whichever is smaller: the flags of those lengths, or the
+// buckets of the k + 1 disjoint trigrams with the fewest flags in total. Names that share a long prefix then cost
+// a few hundred comparisons out of 50k flags; a name with too few rare trigrams still scans its lengths.
+static char *cargs__suggest(cargs_ctx *ctx, const char *name)
+{
+    uint32_t m = (uint32_t)strlen(name);
+    if (m == 0 || m > 64) return NULL;
+
+    uint64_t peq[256], chars = 0;
+    memset(peq, 0, sizeof(peq));
+    for (uint32_t i = 0; i < m; ++i) {
+        peq[(unsigned char)name[i]] |= (uint64_t)1 << i;
+        chars |= (uint64_t)1 << (name[i] & 63);
+    }
 
+    // flags are compared with flags and subcommands with subcommands
+    bool is_flag = name[0] == '-';
+    uint32_t body = m - (!is_flag ? 0 : name[1] == '-' ? 2 : 1);
+    if (body <= 1) return NULL;
+    uint32_t k = CARGS_SUGGEST_DISTANCE < body - 1 ? CARGS_SUGGEST_DISTANCE : body - 1;
+
+    struct cargs__suggestions s;
+    s.n = 0;
+    if (is_flag) {
+        if (ctx->suggest == NULL || ctx->suggest->built != ctx->count + 1) cargs__suggest_build(ctx);
+        struct cargs__suggest_index *x = ctx->suggest;
+        if (++x->query == 0) {
+            memset(x->seen, 0, ctx->count * sizeof(uint32_t));
+            x->query = 1;
         }
 
-        // check if we parsed the flag
-        if (i == cargs__count) {
-            // If the unknown argument looks like a flag, report error
-            if (cargs__is_flag(flag_name)) {
-                cargs__set_error(CARGS_ERROR_UNKNOWN, flag_name, NULL);
-                return false;
+        uint32_t lo = x->lengths[m - k], hi = x->lengths[m + k + 1];
+        // best[t][p] is the least total of t + 1 disjoint trigrams, the last of which starts at p, and from[t][p]
+        // where the one before it starts; k + 1 of them take 3k + 3 characters
+        size_t best[CARGS_SUGGEST_DISTANCE + 1][62], total = SIZE_MAX;
+        uint32_t from[CARGS_SUGGEST_DISTANCE + 1][62], bucket[62], pick[CARGS_SUGGEST_DISTANCE + 1], key = 0;
+        bool by_gram = m >= 3 * k + 3;
+        for (uint32_t j = 0; by_gram && j < m; ++j) {
+            key = key << 8 | (unsigned char)name[j];
+            if (j >= 2) bucket[j - 2] = cargs__gram_bucket(key, x->bits);
+        }
+        for (uint32_t t = 0; by_gram && t <= k; ++t) {
+            size_t low = SIZE_MAX;
+            uint32_t low_at = 0;
+            for (uint32_t p = 3 * t; p < m - 2; ++p) {
+                if (t > 0 && best[t - 1][p - 3] < low) {
+                    low = best[t - 1][p - 3];
+                    low_at = p - 3;
+                }
+                best[t][p] = (t > 0 ? low : 0) + x->buckets[bucket[p] + 1] - x->buckets[bucket[p]];
+                from[t][p] = low_at;
             }
-            // Try to assign to a positional argument
-            int pos_idx = cargs__find_next_positional();
-            if (pos_idx != -1) {
-                cargs__flags[pos_idx].val.string = flag_name;
-                *(char **)(cargs__flags[pos_idx].value_ptr) = flag_name;
-            } else {
-                cargs__set_error(CARGS_ERROR_UNKNOWN, flag_name, NULL);
-                return false;
+        }
+        for (uint32_t p = 3 * k; by_gram && p < m - 2; ++p) {
+            if (best[k][p] < total) {
+                total = best[k][p];
+                pick[k] = p;
+            }
+        }
+        for (uint32_t t = k; by_gram && t > 0; --t) pick[t - 1] = from[t][pick[t]];
+
+        if (!by_gram || total >= hi - lo) {
+            for (uint32_t j = lo; j < hi; ++j) cargs__suggest_flag(ctx, &s, peq, m, chars, x->by_length[j], k);
+        } else {
+            for (uint32_t t = 0; t <= k; ++t) {
+                bool again = false;
+                for (uint32_t u = 0; u < t; ++u) again |= bucket[pick[u]] == bucket[pick[t]];
+                for (uint32_t j = x->buckets[bucket[pick[t]]]; !again && j < x->buckets[bucket[pick[t]] + 1]; ++j) {
+                    cargs__suggest_flag(ctx, &s, peq, m, chars, x->grams[j], k);
+                }
             }
         }
     }
+    // there are few subcommands, so they skip the index
+    for (uint32_t c = 0; !is_flag && c < ctx->ncommands; ++c) {
+        uint32_t len = (uint32_t)strlen(ctx->commands[c].name);
+        cargs__suggest_add(&s, ctx->commands[c].name, cargs__edit_distance(peq, m, ctx->commands[c].name, len, k), c, k);
+    }
+    return s.n > 0 ? cargs__err_names(ctx, s.names, s.n, false) : NULL;
+}
 
-    // Check if any help flag is set
-    for (uint32_t i = 0; i < cargs__count; ++i) {
-        if (cargs__flags[i].is_help && cargs__flags[i].type == CARGS_BOOL && cargs__flags[i].val.boolean) {
-            return true;
-        }
+static bool cargs__parse_expanded(cargs_ctx *ctx, int argc, char **argv);
+
+// index of the subcommand called name, or -1
+static int cargs__find_command(cargs_ctx *ctx, const char *name)
+{
+    for (uint32_t k = 0; k < ctx->ncommands; ++k) {
+        if (strcmp(ctx->commands[k].name, name) == 0) return (int)k;
     }
+    return -1;
+}
 
-    // Validate mandatory positionals
-    for (uint32_t i = 0; i < cargs__count; ++i) {
-        if (cargs__flags[i].type == CARGS_POSITIONAL && cargs__flags[i].mandatory) {
-            if (cargs__flags[i].val.string == NULL) {
-                cargs__set_error(CARGS_ERROR_MISSING_POSITIONAL, cargs__flags[i].name, NULL);
-                return false;
-            }
-        }
+// selects subcommand k and registers its flags on a context of its own, which inherits the settings of ctx
+static cargs_ctx *cargs__select_command(cargs_ctx *ctx, uint32_t k)
+{
+    cargs_ctx *sub = (cargs_ctx *)cargs__alloc(ctx, NULL, 0, sizeof(cargs_ctx));
+    cargs_ctx_init(sub);
+    sub->alloc_fn = ctx->alloc_fn;
+    sub->alloc_user = ctx->alloc_user;
+    sub->abbrev = ctx->abbrev;
+    sub->lazy = ctx->lazy;
+    sub->match_fn = ctx->match_fn;
+    sub->match_user = ctx->match_user;
+    ctx->command = k + 1;
+    ctx->command_ctx = sub;
+    ctx->commands[k].setup(sub, ctx->commands[k].user);
+    return sub;
+}
+
+// Selects the subcommand named argv[0] and parses the rest of argv against its flags, unless the top level asked
+// for help. Errors of the subcommand are copied to ctx.
+static bool cargs__run_command(cargs_ctx *ctx, int argc, char **argv, bool help)
+{
+    int k = cargs__find_command(ctx, argv[0]);
+    if (k == -1) {
+        cargs__set_error(&ctx->err, CARGS_ERROR_UNKNOWN, argv[0], NULL);
+        ctx->err.suggestions = cargs__suggest(ctx, argv[0]);
+        return false;
+    }
+
+    cargs_ctx *sub = cargs__select_command(ctx, (uint32_t)k);
+    if (help) return true;
+
+    // argv[0] takes the place of the program name; response files were expanded by the top level already
+    sub->parsed = true;
+    bool res = cargs__parse_expanded(sub, argc, argv);
+    if (!res) {
+        ctx->err = sub->err;
+        if (ctx->err.command == NULL) ctx->err.command = ctx->commands[k].name;
+    }
+    return res;
+}
+
+// lays out the list flags and completes an error with the candidates or suggestions it lists
+static void cargs__parse_done(cargs_ctx *ctx)
+{
+    cargs__list_build(ctx);
+    if (ctx->err.error == CARGS_ERROR_AMBIGUOUS) ctx->err.value = cargs__abbrev_candidates(ctx, ctx->err.flag);
+    if (ctx->err.error == CARGS_ERROR_UNKNOWN && cargs__is_flag(ctx->err.flag)) ctx->err.suggestions = cargs__suggest(ctx, ctx->err.flag);
+}
+
+// parses argv once response files are expanded
+static bool cargs__parse_expanded(cargs_ctx *ctx, int argc, char **argv)
+{
+    int command = 0;
+    cargs__abbrev_build(ctx);
+    bool res = cargs__parse_core(ctx, argc, argv, NULL, NULL, &ctx->stats, &ctx->err, &command);
+    cargs__parse_done(ctx);
+    if (!res || ctx->ncommands == 0) return res;
+
+    bool help = cargs__help_set(ctx, NULL, NULL);
+    if (command != 0) return cargs__run_command(ctx, argc - command, argv + command, help);
+    if (help) return true;
+    cargs__set_error(&ctx->err, CARGS_ERROR_MISSING_POSITIONAL, "command", NULL);
+    return false;
+}
+
+// marks ctx as parsed and expands response files up front, so the parser sees one flat argv
+static bool cargs__parse_start(cargs_ctx *ctx, int *argc, char ***argv)
+{
+    if (ctx->parsed) {
+        cargs__set_error(&ctx->err, CARGS_ERROR_UNKNOWN, "cargs_parse", NULL);
+        return false;
     }
+    ctx->parsed = true;
 
+    for (int i = 1; i < *argc; ++i) {
+        if ((*argv)[i][0] != '@') continue;
+        bool expand = true;
+        for (int j = 0; j < *argc; ++j) {
+            if (!cargs__rsp_push(ctx, (*argv)[j], j > 0, 0, &expand, &ctx->err)) return false;
+        }
+        *argc = (int)ctx->rsp_argc;
+        *argv = ctx->rsp_argv;
+        break;
+    }
     return true;
 }
 
-void cargs_log_error(FILE *stream)
+static bool cargs__parse_argv(cargs_ctx *ctx, int argc, char **argv)
+{
+    if (!cargs__parse_start(ctx, &argc, &argv)) return false;
+    return cargs__parse_expanded(ctx, argc, argv);
+}
+
+bool cargs_ctx_parse(cargs_ctx *ctx, int argc, char **argv)
+{
+#ifdef CARGS_STATS
+    uint64_t start = cargs__now_ns();
+    bool res = cargs__parse_argv(ctx, argc, argv);
+    ctx->stats.parses++;
+    ctx->stats.parse_ns += cargs__now_ns() - start;
+    return res;
+#else
+    return cargs__parse_argv(ctx, argc, argv);
+#endif
+}
+
+void cargs_ctx_log_error(cargs_ctx *ctx, FILE *stream)
+{
+    cargs_print_error(stream, ctx->err);
+}
+
+void cargs_print_error(FILE *stream, cargs_error err)
 {
     char cargs__type[] = "command";
-    if (cargs__err.flag != NULL && *cargs__err.flag == '-') strcpy(cargs__type, "flag");
+    if (err.flag != NULL && *err.flag == '-') strcpy(cargs__type, "flag");
+    else if (err.source != NULL) strcpy(cargs__type, "key");
+    if (err.command != NULL) fprintf(stream, "%s: ", err.command);
+    if (err.source != NULL && err.line != 0) fprintf(stream, "%s:%u:%u: ", err.source, (unsigned)err.line, (unsigned)err.column);
+    else if (err.source != NULL && err.error != CARGS_ERROR_CONFIG) fprintf(stream, "%s: ", err.source);
 
-    switch (cargs__err.error) {
+    switch (err.error) {
         case CARGS_ERROR_NONE:
             fprintf(stream, "No Error. Please only call cargs_log_error if flag_parse returned false!\n");
         break;
 
         case CARGS_ERROR_UNKNOWN:
-            fprintf(stream, "ERROR: UNKNOWN %s \"%s\"\n", cargs__type, cargs__err.flag);
+            if (err.suggestions != NULL) fprintf(stream, "ERROR: UNKNOWN %s \"%s\", did you mean %s?\n", cargs__type, err.flag, err.suggestions);
+            else fprintf(stream, "ERROR: UNKNOWN %s \"%s\"\n", cargs__type, err.flag);
         break;
 
         case CARGS_ERROR_NO_VALUE:
-            fprintf(stream, "ERROR: NO VALUE provided for %s \"%s\"\n", cargs__type, cargs__err.flag);
+            fprintf(stream, "ERROR: NO VALUE provided for %s \"%s\"\n", cargs__type, err.flag);
         break;
 
         case CARGS_ERROR_INVALID_NUMBER:
-            fprintf(stream, "ERROR: INVALID VALUE for %s \"%s\". Provided value was \"%s\"\n", cargs__type, cargs__err.flag, cargs__err.value);
+            fprintf(stream, "ERROR: INVALID VALUE for %s \"%s\". Provided value was \"%s\"\n", cargs__type, err.flag, err.value);
         break;
 
         case CARGS_ERROR_OVERFLOW:
-            fprintf(stream, "ERROR: OVERFLOW while parsing %s \"%s\". Provided value was \"%s\"\n", cargs__type, cargs__err.flag, cargs__err.value);
+            fprintf(stream, "ERROR: OVERFLOW while parsing %s \"%s\". Provided value was \"%s\"\n", cargs__type, err.flag, err.value);
         break;
 
         case CARGS_ERROR_UNDERFLOW:
-            fprintf(stream, "ERROR: UNDERFLOW while parsing %s \"%s\". Provided value was \"%s\"\n", cargs__type, cargs__err.flag, cargs__err.value);
+            fprintf(stream, "ERROR: UNDERFLOW while parsing %s \"%s\". Provided value was \"%s\"\n", cargs__type, err.flag, err.value);
         break;
 
     case CARGS_ERROR_OUT_OF_BOUNDS:
-        fprintf(stream, "ERROR: Value OUT OF BOUNDS for %s \"%s\". Provided value was \"%s\"\n", cargs__type, cargs__err.flag, cargs__err.value);
+        fprintf(stream, "ERROR: Value OUT OF BOUNDS for %s \"%s\". Provided value was \"%s\"\n", cargs__type, err.flag, err.value);
         break;
     case CARGS_ERROR_MISSING_POSITIONAL:
-        fprintf(stream, "ERROR: MISSING mandatory argument \"%s\"\n", cargs__err.flag);
+        fprintf(stream, "ERROR: MISSING mandatory argument \"%s\"\n", err.flag);
+        break;
+    case CARGS_ERROR_RESPONSE_FILE:
+        fprintf(stream, "ERROR: UNREADABLE response file \"%s\" (missing, unterminated quote or nested too deeply)\n", err.flag);
+        break;
+    case CARGS_ERROR_CONFIG:
+        if (err.line == 0) fprintf(stream, "ERROR: UNREADABLE config file \"%s\"\n", err.flag);
+        else fprintf(stream, "ERROR: INVALID config line, expected name = value\n");
+        break;
+
+    case CARGS_ERROR_AMBIGUOUS:
+        if (err.value != NULL) fprintf(stream, "ERROR: AMBIGUOUS %s \"%s\", could be %s\n", cargs__type, err.flag, err.value);
+        else fprintf(stream, "ERROR: AMBIGUOUS %s \"%s\"\n", cargs__type, err.flag);
+        break;
+    case CARGS_ERROR_STREAM:
+        if (err.flag != NULL) fprintf(stream, "ERROR: \"%s\" cannot take arguments from a stream\n", err.flag);
+        else if (err.line == 0) fprintf(stream, "ERROR: UNREADABLE argument stream\n");
+        else fprintf(stream, "ERROR: argument %u of the stream is longer than the read buffer of %u bytes\n", (unsigned)err.line, (unsigned)CARGS_STREAM_BUFFER);
         break;
 
     case CARGS_ERROR_COUNT:
 
-        default:
-            assert(0 && "Unreachable, Unknown Error");
+        default:
+            assert(0 && "Unreachable, Unknown Error");
+    }
+}
+
+cargs_error cargs_ctx_get_error(cargs_ctx *ctx) {
+    return ctx->err;
+}
+
+void cargs_ctx_reset(cargs_ctx *ctx)
+{
+    // only touch what was registered: the flags themselves and the index, which is sized to them
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        memset(cargs__flag(ctx, i), 0, sizeof(struct cargs_flag));
+        memset(cargs__info(ctx, i), 0, sizeof(struct cargs__flag_info));
+    }
+    if (ctx->index_shared) {
+        // the index belonged to an adopted snapshot
+        ctx->index = NULL;
+        ctx->index_cap = 0;
+        ctx->index_shared = false;
+    }
+    if (ctx->index != NULL) memset(ctx->index, 0, ctx->index_cap * sizeof(*ctx->index));
+    cargs__rsp_release(ctx);
+    for (uint32_t i = 0; i < ctx->stream_nvalues; ++i) {
+        if (ctx->stream_values[i].text != NULL) cargs__alloc(ctx, ctx->stream_values[i].text, ctx->stream_values[i].size, 0);
+    }
+    if (ctx->stream_values != NULL) cargs__alloc(ctx, ctx->stream_values, ctx->stream_nvalues * sizeof(*ctx->stream_values), 0);
+    ctx->stream_values = NULL;
+    ctx->stream_nvalues = 0;
+    if (ctx->command_ctx != NULL) {
+        cargs_ctx_free(ctx->command_ctx);
+        cargs__alloc(ctx, ctx->command_ctx, sizeof(cargs_ctx), 0);
+        ctx->command_ctx = NULL;
+    }
+    ctx->ncommands = 0;
+    ctx->command = 0;
+    ctx->npending = 0;
+    ctx->help_len = 0;
+    ctx->list_nitems = 0;
+    ctx->abbrev_count = 0;
+    ctx->abbrev_built = 0;
+    if (ctx->suggest != NULL) ctx->suggest->built = 0;
+    ctx->count  = 0;
+    ctx->parsed = false;
+    memset(&ctx->err, 0, sizeof(ctx->err));
+}
+
+// help text: rendered into one buffer, measured by the same code that writes it
+
+// output that is only stored while it fits, like the snapshot string pool
+struct cargs__text {
+    char *buf;
+    size_t size;
+    size_t len;
+};
+
+static void cargs__text_put(struct cargs__text *t, const char *s, size_t n)
+{
+    if (t->len + n <= t->size) memcpy(t->buf + t->len, s, n);
+    t->len += n;
+}
+
+static void cargs__text_pad(struct cargs__text *t, size_t n)
+{
+    if (t->len + n <= t->size) memset(t->buf + t->len, ' ', n);
+    t->len += n;
+}
+
+// Appends s from column col on, wrapped at width: lines break at spaces, continue at col and end with a newline.
+// Words longer than a line stay whole.
+static void cargs__text_wrap(struct cargs__text *t, const char *s, size_t col, size_t width)
+{
+    size_t room = width > col + 20 ? width - col : 20;
+    for (;;) {
+        size_t n = strcspn(s, "\n");
+        while (n > room) {
+            size_t cut = room;
+            while (cut > 0 && s[cut] != ' ') cut--;
+            if (cut == 0) {
+                cut = 1;
+                while (cut < n && s[cut] != ' ') cut++;
+            }
+            if (cut >= n) break;
+            cargs__text_put(t, s, cut);
+            cargs__text_put(t, "\n", 1);
+            while (cut < n && s[cut] == ' ') cut++;
+            s += cut;
+            n -= cut;
+            cargs__text_pad(t, col);
+        }
+        cargs__text_put(t, s, n);
+        cargs__text_put(t, "\n", 1);
+        if (s[n] == '\0') return;
+        s += n + 1;
+        cargs__text_pad(t, col);
+    }
+}
+
+// the "Default: ..." line of flag, or its kind for positionals and lists
+static void cargs__text_default(struct cargs__text *t, const struct cargs_flag *flag, const struct cargs__flag_info *info)
+{
+    if (flag->list) {
+        if (flag->type != CARGS_POSITIONAL) cargs__text_put(t, "Repeatable", 10);
+        else if (flag->mandatory) cargs__text_put(t, "Mandatory, repeatable", 21);
+        else cargs__text_put(t, "Optional, repeatable", 20);
+        return;
+    }
+    if (flag->type == CARGS_POSITIONAL) {
+        if (flag->mandatory) cargs__text_put(t, "Mandatory", 9);
+        else cargs__text_put(t, "Optional", 8);
+        return;
+    }
+
+    char num[64];
+    int n = 0;
+    const char *s = NULL;
+    switch (flag->type) {
+        case CARGS_BOOL:        s = info->def.boolean ? "true" : "false"; break;
+        case CARGS_CHAR:        num[0] = info->def.character; n = 1; break;
+        case CARGS_STRING:      s = info->def.string ? info->def.string : "(NULL)"; break;
+        case CARGS_INT8:        n = snprintf(num, sizeof(num), "%d", info->def.int8); break;
+        case CARGS_UINT8:       n = snprintf(num, sizeof(num), "%u", info->def.uint8); break;
+        case CARGS_INT16:       n = snprintf(num, sizeof(num), "%d", info->def.int16); break;
+        case CARGS_UINT16:      n = snprintf(num, sizeof(num), "%u", info->def.uint16); break;
+        case CARGS_INT32:       n = snprintf(num, sizeof(num), "%d", info->def.int32); break;
+        case CARGS_UINT32:      n = snprintf(num, sizeof(num), "%u", info->def.uint32); break;
+        case CARGS_INT64:       n = snprintf(num, sizeof(num), "%" PRId64, info->def.int64); break;
+        case CARGS_UINT64:      n = snprintf(num, sizeof(num), "%" PRIu64, info->def.uint64); break;
+        case CARGS_FLOAT:       n = snprintf(num, sizeof(num), "%g", info->def.floating); break;
+        case CARGS_DOUBLE:      n = snprintf(num, sizeof(num), "%g", info->def.double_val); break;
+        case CARGS_LONG_DOUBLE: n = snprintf(num, sizeof(num), "%Lg", info->def.long_double); break;
+        case CARGS_SIZE_T:      n = snprintf(num, sizeof(num), "%zu", info->def.size); break;
+
+        case CARGS_POSITIONAL:
+        case CARGS_TYPE_COUNT:
+        default:
+            assert(0 && "Unreachable, Unknown Type");
+            exit(69);
+    }
+    cargs__text_put(t, "Default: ", 9);
+    if (s != NULL) cargs__text_put(t, s, strlen(s));
+    else cargs__text_put(t, num, n > 0 ? (size_t)n : 0);
+}
+
+// one entry: the names, padded to col, then the wrapped description and below it the default or kind
+static void cargs__text_entry(struct cargs__text *t, const char *name, const char *alias, const char *desc,
+                              const struct cargs_flag *flag, const struct cargs__flag_info *info, const char *kind,
+                              size_t col, size_t width)
+{
+    size_t used = 4 + strlen(name);
+    cargs__text_pad(t, 4);
+    cargs__text_put(t, name, strlen(name));
+    if (alias != NULL) {
+        cargs__text_put(t, ", ", 2);
+        cargs__text_put(t, alias, strlen(alias));
+        used += 2 + strlen(alias);
+    }
+    // names too wide for the column get a line of their own
+    if (used + 2 > col) {
+        cargs__text_put(t, "\n", 1);
+        used = 0;
+    }
+    cargs__text_pad(t, col - used);
+    cargs__text_wrap(t, desc != NULL ? desc : "", col, width);
+
+    if (flag == NULL && kind == NULL) return;
+    cargs__text_pad(t, col);
+    if (flag != NULL) cargs__text_default(t, flag, info);
+    else cargs__text_put(t, kind, strlen(kind));
+    cargs__text_put(t, "\n", 1);
+}
+
+// Renders the help text into buf if it fits in size bytes with a terminating NUL; returns its length either way.
+static size_t cargs__render(cargs_ctx *ctx, char *buf, size_t size, bool printdefault, size_t width)
+{
+    // descriptions start in one column after the widest names, up to CARGS_HELP_NAMES characters
+    size_t names = 0;
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->alias_of != 0) continue;
+        const char *alias = cargs__info(ctx, i)->alias;
+        size_t w = strlen(flag->name) + (alias != NULL ? 2 + strlen(alias) : 0);
+        if (w > names) names = w;
+    }
+    for (uint32_t k = 0; k < ctx->ncommands; ++k) {
+        size_t w = strlen(ctx->commands[k].name);
+        if (w > names) names = w;
+    }
+    size_t col = 4 + (names < CARGS_HELP_NAMES ? names : CARGS_HELP_NAMES) + 2;
+
+    struct cargs__text t;
+    t.buf = buf;
+    t.size = size;
+    t.len = 0;
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->alias_of != 0) continue;
+        struct cargs__flag_info *info = cargs__info(ctx, i);
+        cargs__text_entry(&t, flag->name, info->alias, info->desc, printdefault ? flag : NULL, info, NULL, col, width);
+    }
+    for (uint32_t k = 0; k < ctx->ncommands; ++k) {
+        cargs__text_entry(&t, ctx->commands[k].name, NULL, ctx->commands[k].desc, NULL, NULL, printdefault ? "Subcommand" : NULL, col, width);
+    }
+    if (t.len < size) buf[t.len] = '\0';
+    return t.len;
+}
+
+// columns of the terminal behind stream, else $COLUMNS, else CARGS_HELP_WIDTH
+static size_t cargs__help_width(FILE *stream)
+{
+#if CARGS__TERMINAL
+    int fd = stream == stdout ? STDOUT_FILENO : stream == stderr ? STDERR_FILENO : -1;
+    struct winsize ws;
+    if (fd != -1 && ioctl(fd, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) return ws.ws_col;
+#else
+    (void)stream;
+#endif
+    uint64_t columns;
+    const char *env = getenv("COLUMNS");
+    if (env != NULL && cargs_str2uint(&columns, env, 1, 10000) == CARGS_ERROR_NONE) return (size_t)columns;
+    return CARGS_HELP_WIDTH;
+}
+
+// the help text for the given settings; it is only rendered again after flags or subcommands were added
+static const char *cargs__help_text(cargs_ctx *ctx, bool printdefault, size_t width)
+{
+    if (ctx->help_len != 0 && ctx->help_count == ctx->count && ctx->help_commands == ctx->ncommands &&
+        ctx->help_defaults == printdefault && ctx->help_width == width) {
+        return ctx->help_text;
+    }
+    size_t len = cargs__render(ctx, NULL, 0, printdefault, width);
+    if (len + 1 > ctx->help_size) {
+        if (ctx->help_text != NULL) cargs__alloc(ctx, ctx->help_text, ctx->help_size, 0);
+        ctx->help_text = (char *)cargs__alloc(ctx, NULL, 0, len + 1);
+        ctx->help_size = len + 1;
+    }
+    cargs__render(ctx, ctx->help_text, len + 1, printdefault, width);
+    ctx->help_len = len;
+    ctx->help_count = ctx->count;
+    ctx->help_commands = ctx->ncommands;
+    ctx->help_defaults = printdefault;
+    ctx->help_width = width;
+    return ctx->help_text;
+}
+
+void cargs_ctx_log_options(cargs_ctx *ctx, FILE *stream, bool printdefault)
+{
+#ifdef CARGS_STATS
+    uint64_t start = cargs__now_ns();
+#endif
+    const char *text = cargs__help_text(ctx, printdefault, cargs__help_width(stream));
+    fwrite(text, 1, ctx->help_len, stream);
+#ifdef CARGS_STATS
+    ctx->stats.log_options_ns += cargs__now_ns() - start;
+#endif
+}
+
+size_t cargs_ctx_render_options(cargs_ctx *ctx, char *buf, size_t len)
+{
+    const char *text = cargs__help_text(ctx, true, cargs__help_width(NULL));
+    if (ctx->help_len < len) memcpy(buf, text, ctx->help_len + 1);
+    return ctx->help_len;
+}
+
+cargs_stats cargs_ctx_get_stats(cargs_ctx *ctx)
+{
+    cargs_stats stats = ctx->stats;
+    stats.flags = ctx->count;
+    stats.registry_bytes = (size_t)ctx->capacity * (sizeof(struct cargs_flag) + sizeof(struct cargs__flag_info));
+    if (!ctx->index_shared) stats.registry_bytes += ctx->index_cap * sizeof(*ctx->index);
+    stats.registry_bytes += ctx->rsp_argv_cap * sizeof(*ctx->rsp_argv);
+    stats.registry_bytes += ctx->rsp_files_cap * sizeof(*ctx->rsp_files);
+    for (uint32_t i = 0; i < ctx->rsp_nfiles; ++i) {
+        stats.registry_bytes += ctx->rsp_files[i].size;
+    }
+    stats.registry_bytes += ctx->list_items_cap * sizeof(*ctx->list_items) + ctx->list_arena_size;
+    stats.registry_bytes += ctx->abbrev_cap * sizeof(*ctx->abbrev_names) + ctx->err_text_size;
+    if (ctx->suggest != NULL) stats.registry_bytes += sizeof(*ctx->suggest) + ctx->suggest->mem_size + ctx->suggest->grams_cap * sizeof(uint32_t);
+    stats.registry_bytes += ctx->commands_cap * sizeof(*ctx->commands) + ctx->pending_cap * sizeof(*ctx->pending);
+    stats.registry_bytes += ctx->help_size;
+    if (ctx->stream_buf != NULL) stats.registry_bytes += CARGS_STREAM_BUFFER + 1;
+    stats.registry_bytes += ctx->stream_held_size;
+    stats.registry_bytes += ctx->stream_nvalues * sizeof(*ctx->stream_values);
+    for (uint32_t i = 0; i < ctx->stream_nvalues; ++i) {
+        stats.registry_bytes += ctx->stream_values[i].size;
+    }
+    if (ctx->command_ctx != NULL) stats.registry_bytes += sizeof(cargs_ctx) + cargs_ctx_get_stats(ctx->command_ctx).registry_bytes;
+    return stats;
+}
+
+void cargs_ctx_reset_stats(cargs_ctx *ctx)
+{
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+}
+
+void cargs_ctx_set_match_hook(cargs_ctx *ctx, cargs_match_fn fn, void *user)
+{
+    ctx->match_fn = fn;
+    ctx->match_user = user;
+}
+
+
+void cargs_batch_init(cargs_batch *batch, cargs_ctx *schema, size_t rows)
+{
+    if (schema == NULL) schema = &cargs__default_ctx;
+
+    memset(batch, 0, sizeof(*batch));
+    batch->schema = schema;
+    batch->nflags = schema->count;
+    batch->rows   = rows;
+    // the + 1 on every size keeps empty batches from requesting zero bytes, which the allocator treats as free
+    assert(schema->ncommands == 0 && "cargs_batch_init: subcommands cannot be parsed in batches");
+    batch->errors = (cargs_error *)cargs__alloc(schema, NULL, 0, rows * sizeof(cargs_error) + 1);
+    memset(batch->errors, 0, rows * sizeof(cargs_error));
+    batch->columns = (void **)cargs__alloc(schema, NULL, 0, batch->nflags * sizeof(void *) + 1);
+    cargs__abbrev_build(schema); // rows only read the abbreviation index
+
+    // fill every column with its default once, so parsing a row only writes the flags it names
+    for (uint32_t i = 0; i < batch->nflags; ++i) {
+        struct cargs_flag *flag = cargs__flag(schema, i);
+        assert(!flag->list && "cargs_batch_init: list flags cannot be parsed in batches");
+        size_t size = cargs__type_size(flag->type);
+        char *column = (char *)cargs__alloc(schema, NULL, 0, rows * size + 1);
+        for (size_t r = 0; r < rows; ++r) {
+            memcpy(column + r * size, &cargs__info(schema, i)->def, size);
+        }
+        batch->columns[i] = column;
+    }
+}
+
+struct cargs__batch_row {
+    cargs_batch *batch;
+    size_t row;
+};
+
+static void *cargs__batch_target(void *user, uint32_t i)
+{
+    struct cargs__batch_row *row = (struct cargs__batch_row *)user;
+    assert(i < row->batch->nflags && "Flag registered after cargs_batch_init()!");
+    size_t size = cargs__type_size(cargs__flag(row->batch->schema, i)->type);
+    return (char *)row->batch->columns[i] + row->row * size;
+}
+
+size_t cargs_batch_parse(cargs_batch *batch, size_t first, size_t count, const int *argcs, char **const *argvs)
+{
+    assert(first + count <= batch->rows);
+
+    size_t failed = 0;
+    for (size_t r = first; r < first + count; ++r) {
+        struct cargs__batch_row row = { batch, r };
+        if (!cargs__parse_core(batch->schema, argcs[r], argvs[r], cargs__batch_target, &row, NULL, &batch->errors[r], NULL)) {
+            failed++;
+        }
+    }
+    return failed;
+}
+
+const void *cargs_batch_column(const cargs_batch *batch, const char *name)
+{
+    int i = cargs__lookup(batch->schema, name);
+    if (i == -1 || (uint32_t)i >= batch->nflags) return NULL;
+    return batch->columns[i];
+}
+
+void cargs_batch_free(cargs_batch *batch)
+{
+    for (uint32_t i = 0; i < batch->nflags; ++i) {
+        size_t size = cargs__type_size(cargs__flag(batch->schema, i)->type);
+        cargs__alloc(batch->schema, batch->columns[i], batch->rows * size + 1, 0);
+    }
+    cargs__alloc(batch->schema, batch->columns, batch->nflags * sizeof(void *) + 1, 0);
+    cargs__alloc(batch->schema, batch->errors, batch->rows * sizeof(cargs_error) + 1, 0);
+    memset(batch, 0, sizeof(*batch));
+}
+// live reload: values built off to the side and published with one atomic pointer swap
+
+#if CARGS_LIVE
+// Sequentially consistent atomics, which the reader counters rely on.
+#if defined(__GNUC__) || defined(__clang__)
+static long cargs__atomic_load(long *p)
+{
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+static void cargs__atomic_store(long *p, long v)
+{
+    __atomic_store_n(p, v, __ATOMIC_SEQ_CST);
+}
+
+static void cargs__atomic_add(long *p, long n)
+{
+    __atomic_fetch_add(p, n, __ATOMIC_SEQ_CST);
+}
+
+static void *cargs__atomic_load_ptr(void **p)
+{
+    return __atomic_load_n(p, __ATOMIC_SEQ_CST);
+}
+
+static void *cargs__atomic_swap_ptr(void **p, void *v)
+{
+    return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST);
+}
+#elif defined(_MSC_VER)
+#   include <intrin.h>
+static long cargs__atomic_load(long *p)
+{
+    return _InterlockedOr(p, 0);
+}
+
+static void cargs__atomic_store(long *p, long v)
+{
+    _InterlockedExchange(p, v);
+}
+
+static void cargs__atomic_add(long *p, long n)
+{
+    _InterlockedExchangeAdd(p, n);
+}
+
+static void *cargs__atomic_load_ptr(void **p)
+{
+    return _InterlockedCompareExchangePointer(p, NULL, NULL);
+}
+
+static void *cargs__atomic_swap_ptr(void **p, void *v)
+{
+    return _InterlockedExchangePointer(p, v);
+}
+#else
+#   include <stdatomic.h>
+// The fields of cargs_live are plain so the header stays valid C++; lock-free atomics of the same size share
+// their representation, so the fields are accessed through atomic pointers.
+CARGS_STATIC_ASSERT(ATOMIC_LONG_LOCK_FREE == 2 && sizeof(atomic_long) == sizeof(long), "cargs_live needs lock-free atomic long");
+CARGS_STATIC_ASSERT(ATOMIC_POINTER_LOCK_FREE == 2 && sizeof(_Atomic(void *)) == sizeof(void *), "cargs_live needs lock-free atomic pointers");
+
+static long cargs__atomic_load(long *p)
+{
+    return atomic_load((atomic_long *)p);
+}
+
+static void cargs__atomic_store(long *p, long v)
+{
+    atomic_store((atomic_long *)p, v);
+}
+
+static void cargs__atomic_add(long *p, long n)
+{
+    atomic_fetch_add((atomic_long *)p, n);
+}
+
+static void *cargs__atomic_load_ptr(void **p)
+{
+    return atomic_load((_Atomic(void *) *)p);
+}
+
+static void *cargs__atomic_swap_ptr(void **p, void *v)
+{
+    return atomic_exchange((_Atomic(void *) *)p, v);
+}
+#endif
+
+static void cargs__yield(void)
+{
+#if CARGS__MMAP
+    sched_yield();
+#endif
+}
+
+// a set of live values in one allocation: the header, the value slots, then copies of the string values
+struct cargs__live_block {
+    cargs_live_values head;
+    union cargs_value values[1];
+};
+
+static void *cargs__live_target(void *user, uint32_t i)
+{
+    return (union cargs_value *)user + i;
+}
+
+// copies vals, and the strings they point to, into a new set of values
+static cargs_live_values *cargs__live_copy(cargs_live *live, const union cargs_value *vals, uint64_t version)
+{
+    size_t size = offsetof(struct cargs__live_block, values) + live->nflags * sizeof(union cargs_value);
+    for (uint32_t i = 0; i < live->nflags; ++i) {
+        enum cargs_type type = cargs__flag(live->schema, i)->type;
+        if ((type == CARGS_STRING || type == CARGS_POSITIONAL) && vals[i].string != NULL) size += strlen(vals[i].string) + 1;
+    }
+
+    struct cargs__live_block *block = (struct cargs__live_block *)cargs__alloc(live->schema, NULL, 0, size);
+    block->head.schema = live->schema;
+    block->head.version = version;
+    block->head.nflags = live->nflags;
+    block->head.values = block->values;
+    block->head.size = size;
+    memcpy(block->values, vals, live->nflags * sizeof(union cargs_value));
+    char *text = (char *)(block->values + live->nflags);
+    for (uint32_t i = 0; i < live->nflags; ++i) {
+        enum cargs_type type = cargs__flag(live->schema, i)->type;
+        if ((type != CARGS_STRING && type != CARGS_POSITIONAL) || vals[i].string == NULL) continue;
+        size_t len = strlen(vals[i].string) + 1;
+        memcpy(text, vals[i].string, len);
+        block->values[i].string = text;
+        text += len;
+    }
+    return &block->head;
+}
+
+// Publishes values and frees the set they replace once no reader can hold it any more. Readers join the counter
+// the epoch selects, so after the epoch flips, only those counted before can hold the old set, and new readers
+// find the new one.
+static void cargs__live_publish(cargs_live *live, cargs_live_values *values)
+{
+    cargs_live_values *old = (cargs_live_values *)cargs__atomic_swap_ptr(&live->current, values);
+    if (old == NULL) return;
+    long slot = cargs__atomic_load(&live->epoch) & 1;
+    cargs__atomic_store(&live->epoch, slot ^ 1);
+    while (cargs__atomic_load(&live->readers[slot * 16]) != 0) {
+        cargs__yield();
+    }
+    cargs__alloc(live->schema, old, old->size, 0);
+}
+
+// unmaps or frees the config file of the last reload
+static void cargs__live_unload(cargs_live *live)
+{
+    if (live->config == NULL) return;
+    struct cargs__rsp_file file = { live->config, 0, live->config_size, live->config_mapped };
+    cargs__rsp_unload(live->schema, &file);
+    live->config = NULL;
+}
+
+bool cargs_live_init(cargs_live *live, cargs_ctx *schema)
+{
+    if (schema == NULL) schema = &cargs__default_ctx;
+
+    memset(live, 0, sizeof(*live));
+    live->schema = schema;
+    live->nflags = schema->count;
+    assert(schema->ncommands == 0 && "cargs_live_init: subcommands cannot be reloaded");
+    cargs__abbrev_build(schema); // reloads only read the abbreviation index
+
+    // the + 1 keeps an empty registry from requesting zero bytes, which the allocator treats as free
+    union cargs_value *vals = (union cargs_value *)cargs__alloc(schema, NULL, 0, live->nflags * sizeof(*vals) + 1);
+    for (uint32_t i = 0; i < live->nflags; ++i) {
+        struct cargs_flag *flag = cargs__flag(schema, i);
+        assert(!flag->list && "cargs_live_init: list flags cannot be reloaded");
+        if (!cargs__lazy_convert(schema, i)) {
+            live->err = schema->err;
+            cargs__alloc(schema, vals, live->nflags * sizeof(*vals) + 1, 0);
+            return false;
+        }
+        memcpy(&vals[i], cargs__info(schema, i)->value_ptr, cargs__type_size(flag->type));
+    }
+    cargs__live_publish(live, cargs__live_copy(live, vals, 1));
+    cargs__alloc(schema, vals, live->nflags * sizeof(*vals) + 1, 0);
+    return true;
+}
+
+bool cargs_live_reload(cargs_live *live, const char *config, int argc, char **argv)
+{
+    cargs_ctx *schema = live->schema;
+    assert(schema->count == live->nflags && "Flag registered after cargs_live_init()!");
+
+    union cargs_value *vals = (union cargs_value *)cargs__alloc(schema, NULL, 0, live->nflags * sizeof(*vals) + 1);
+    for (uint32_t i = 0; i < live->nflags; ++i) {
+        vals[i] = cargs__info(schema, i)->def;
+    }
+
+    // the previous file was kept until now, since the error of a failed reload may point into it
+    cargs__live_unload(live);
+    memset(&live->err, 0, sizeof(live->err));
+    bool ok = true;
+    if (config != NULL) {
+        struct cargs__rsp_file file;
+        if (cargs__rsp_load(schema, config, &file)) {
+            live->config = file.data;
+            live->config_size = file.size;
+            live->config_mapped = file.mapped;
+            ok = cargs__config_apply(schema, config, file.data, cargs__live_target, vals, &live->err);
+        } else {
+            ok = cargs__config_error(&live->err, CARGS_ERROR_CONFIG, config, 0, NULL, NULL, config, NULL);
+        }
+    }
+    if (ok && argc > 0) ok = cargs__parse_core(schema, argc, argv, cargs__live_target, vals, NULL, &live->err, NULL);
+
+    if (ok) {
+        // only reloads replace the published set, so this thread may read it without acquiring it
+        uint64_t version = ((cargs_live_values *)live->current)->version + 1;
+        cargs__live_publish(live, cargs__live_copy(live, vals, version));
+    }
+    cargs__alloc(schema, vals, live->nflags * sizeof(*vals) + 1, 0);
+    return ok;
+}
+
+cargs_live_read cargs_live_acquire(cargs_live *live)
+{
+    // join the counter of the current epoch, and again if a reload flipped it in between: a reload that flips
+    // it later waits for this reader
+    cargs_live_read read;
+    for (;;) {
+        read.slot = cargs__atomic_load(&live->epoch) & 1;
+        cargs__atomic_add(&live->readers[read.slot * 16], 1);
+        if ((cargs__atomic_load(&live->epoch) & 1) == read.slot) break;
+        cargs__atomic_add(&live->readers[read.slot * 16], -1);
+    }
+    read.values = (const cargs_live_values *)cargs__atomic_load_ptr(&live->current);
+    return read;
+}
+
+void cargs_live_release(cargs_live *live, cargs_live_read read)
+{
+    cargs__atomic_add(&live->readers[read.slot * 16], -1);
+}
+
+const void *cargs_live_value(const cargs_live_values *values, const char *name)
+{
+    int i = cargs__lookup(values->schema, name);
+    if (i == -1 || (uint32_t)i >= values->nflags) return NULL;
+    return (const union cargs_value *)values->values + i;
+}
+
+void cargs_live_free(cargs_live *live)
+{
+    cargs_live_values *values = (cargs_live_values *)live->current;
+    if (values != NULL) cargs__alloc(live->schema, values, values->size, 0);
+    cargs__live_unload(live);
+    memset(live, 0, sizeof(*live));
+}
+#endif // CARGS_LIVE
+
+// default context wrappers
+
+#define CARGS_DEFAULT_IMPL(type_name, type_t) \
+type_t * cargs_##type_name(const char *name, const char *desc, type_t def) \
+{ \
+    return cargs_ctx_##type_name(&cargs__default_ctx, name, desc, def); \
+} \
+void cargs_##type_name##_ref(const char *name, const char *desc, type_t *ref, type_t def) \
+{ \
+    cargs_ctx_##type_name##_ref(&cargs__default_ctx, name, desc, ref, def); \
+}
+
+CARGS_DEFAULT_IMPL(bool, bool)
+CARGS_DEFAULT_IMPL(char, char)
+CARGS_DEFAULT_IMPL(int8, int8_t)
+CARGS_DEFAULT_IMPL(uint8, uint8_t)
+CARGS_DEFAULT_IMPL(int16, int16_t)
+CARGS_DEFAULT_IMPL(uint16, uint16_t)
+CARGS_DEFAULT_IMPL(int32, int32_t)
+CARGS_DEFAULT_IMPL(uint32, uint32_t)
+CARGS_DEFAULT_IMPL(int64, int64_t)
+CARGS_DEFAULT_IMPL(uint64, uint64_t)
+CARGS_DEFAULT_IMPL(int, int)
+CARGS_DEFAULT_IMPL(size_t, size_t)
+CARGS_DEFAULT_IMPL(float, float)
+CARGS_DEFAULT_IMPL(double, double)
+CARGS_DEFAULT_IMPL(long_double, long double)
+
+char ** cargs_string(const char *name, const char *desc, const char *def)
+{
+    return cargs_ctx_string(&cargs__default_ctx, name, desc, def);
+}
+
+void cargs_string_ref(const char *name, const char *desc, char **ref, const char *def)
+{
+    cargs_ctx_string_ref(&cargs__default_ctx, name, desc, ref, def);
+}
+
+char ** cargs_positional(const char *name, const char *desc, bool mandatory)
+{
+    return cargs_ctx_positional(&cargs__default_ctx, name, desc, mandatory);
+}
+
+#define CARGS_DEFAULT_LIST_IMPL(type_name) \
+cargs_list * cargs_##type_name##_list(const char *name, const char *desc) \
+{ \
+    return cargs_ctx_##type_name##_list(&cargs__default_ctx, name, desc); \
+}
+
+CARGS_DEFAULT_LIST_IMPL(bool)
+CARGS_DEFAULT_LIST_IMPL(char)
+CARGS_DEFAULT_LIST_IMPL(int8)
+CARGS_DEFAULT_LIST_IMPL(uint8)
+CARGS_DEFAULT_LIST_IMPL(int16)
+CARGS_DEFAULT_LIST_IMPL(uint16)
+CARGS_DEFAULT_LIST_IMPL(int32)
+CARGS_DEFAULT_LIST_IMPL(uint32)
+CARGS_DEFAULT_LIST_IMPL(int64)
+CARGS_DEFAULT_LIST_IMPL(uint64)
+CARGS_DEFAULT_LIST_IMPL(int)
+CARGS_DEFAULT_LIST_IMPL(size_t)
+CARGS_DEFAULT_LIST_IMPL(float)
+CARGS_DEFAULT_LIST_IMPL(double)
+CARGS_DEFAULT_LIST_IMPL(long_double)
+CARGS_DEFAULT_LIST_IMPL(string)
+
+cargs_list * cargs_rest(const char *name, const char *desc, bool mandatory)
+{
+    return cargs_ctx_rest(&cargs__default_ctx, name, desc, mandatory);
+}
+
+void cargs_command(const char *name, const char *desc, cargs_command_fn setup, void *user)
+{
+    cargs_ctx_command(&cargs__default_ctx, name, desc, setup, user);
+}
+
+const char *cargs_selected_command(void)
+{
+    return cargs_ctx_selected_command(&cargs__default_ctx);
+}
+
+cargs_ctx *cargs_command_ctx(void)
+{
+    return cargs_ctx_command_ctx(&cargs__default_ctx);
+}
+
+bool cargs_complete(int argc, char **argv)
+{
+    return cargs_ctx_complete(&cargs__default_ctx, argc, argv);
+}
+
+bool cargs_parse_fd(int argc, char **argv, int fd, char delim, cargs_rest_fn rest, void *rest_user)
+{
+    return cargs_ctx_parse_fd(&cargs__default_ctx, argc, argv, fd, delim, rest, rest_user);
+}
+
+bool cargs_parse_stream(int argc, char **argv, cargs_read_fn read, void *read_user, char delim, cargs_rest_fn rest, void *rest_user)
+{
+    return cargs_ctx_parse_stream(&cargs__default_ctx, argc, argv, read, read_user, delim, rest, rest_user);
+}
+
+void cargs_mark_help(const char *name)
+{
+    cargs_ctx_mark_help(&cargs__default_ctx, name);
+}
+
+void cargs_allow_abbrev(bool enable)
+{
+    cargs_ctx_allow_abbrev(&cargs__default_ctx, enable);
+}
+
+void cargs_alias(const char *alias, const char *name)
+{
+    cargs_ctx_alias(&cargs__default_ctx, alias, name);
+}
+
+bool cargs_parse(int argc, char **argv)
+{
+    return cargs_ctx_parse(&cargs__default_ctx, argc, argv);
+}
+
+bool cargs_load_config(const char *path)
+{
+    return cargs_ctx_load_config(&cargs__default_ctx, path);
+}
+
+void cargs_bind_env(const char *name, const char *env)
+{
+    cargs_ctx_bind_env(&cargs__default_ctx, name, env);
+}
+
+bool cargs_load_env(const char *prefix)
+{
+    return cargs_ctx_load_env(&cargs__default_ctx, prefix);
+}
+
+size_t cargs_snapshot(void *buf, size_t size, const char *schema_id)
+{
+    return cargs_ctx_snapshot(&cargs__default_ctx, buf, size, schema_id);
+}
+
+bool cargs_adopt(const void *blob, size_t size, const char *schema_id)
+{
+    return cargs_ctx_adopt(&cargs__default_ctx, blob, size, schema_id);
+}
+
+bool cargs_adopt_file(const char *path, const char *schema_id)
+{
+    return cargs_ctx_adopt_file(&cargs__default_ctx, path, schema_id);
+}
+
+void *cargs_value(const char *name)
+{
+    return cargs_ctx_value(&cargs__default_ctx, name);
+}
+
+void cargs_lazy(bool enable)
+{
+    cargs_ctx_lazy(&cargs__default_ctx, enable);
+}
+
+bool cargs_validate(void)
+{
+    return cargs_ctx_validate(&cargs__default_ctx);
+}
+
+void cargs_log_error(FILE *stream)
+{
+    cargs_ctx_log_error(&cargs__default_ctx, stream);
+}
+
+cargs_error cargs_get_error()
+{
+    return cargs_ctx_get_error(&cargs__default_ctx);
+}
+
+void cargs_log_options(FILE *stream, bool printdefault)
+{
+    cargs_ctx_log_options(&cargs__default_ctx, stream, printdefault);
+}
+
+size_t cargs_render_options(char *buf, size_t len)
+{
+    return cargs_ctx_render_options(&cargs__default_ctx, buf, len);
+}
+
+cargs_stats cargs_get_stats(void)
+{
+    return cargs_ctx_get_stats(&cargs__default_ctx);
+}
+
+void cargs_reset_stats(void)
+{
+    cargs_ctx_reset_stats(&cargs__default_ctx);
+}
+
+void cargs_set_match_hook(cargs_match_fn fn, void *user)
+{
+    cargs_ctx_set_match_hook(&cargs__default_ctx, fn, user);
+}
+
+void cargs_reset(void)
+{
+    cargs_ctx_reset(&cargs__default_ctx);
+}
+
+void cargs_set_allocator(cargs_alloc_fn fn, void *user)
+{
+    cargs_ctx_set_allocator(&cargs__default_ctx, fn, user);
+}
+
+void cargs_reserve(uint32_t nflags)
+{
+    cargs_ctx_reserve(&cargs__default_ctx, nflags);
+}
+
+void cargs_free(void)
+{
+    cargs_ctx_free(&cargs__default_ctx);
+}
+
+
+// helper functions
+
+// Registers a flag with provided type, name and description as flag ctx->count - 1 and returns its info; the
+// callers fill in its value, and whatever struct cargs_flag holds besides name and type.
+static struct cargs__flag_info *cargs__new(cargs_ctx *ctx, enum cargs_type type, const char *name, const char *desc)
+{
+    assert(!ctx->parsed && "Flag registered after cargs_parse() was called — register all flags before parsing!");
+
+    assert(ctx->count < UINT32_MAX / 2 && "To many flags!");
+    cargs__grow(ctx, ctx->count + 1);
+
+    // Find the insertion slot in the index, checking for a duplicate flag name on the way
+    uint32_t hash = cargs__hash(name);
+    uint32_t slot = hash & (ctx->index_cap - 1);
+    while (ctx->index[slot] != 0) {
+        struct cargs_flag *other = cargs__flag(ctx, ctx->index[slot] - 1);
+        if (other->hash == hash && strcmp(other->name, name) == 0) {
+            assert(0 && "Duplicate flag name!");
+        }
+        slot = (slot + 1) & (ctx->index_cap - 1);
+    }
+    ctx->index[slot] = ctx->count + 1;
+
+    struct cargs_flag *flag = cargs__flag(ctx, ctx->count);
+    struct cargs__flag_info *info = cargs__info(ctx, ctx->count++);
+    memset(flag, 0, sizeof(*flag));
+    memset(info, 0, sizeof(*info));
+
+    flag->type  = type;
+    flag->hash  = hash;
+    flag->name = (char*) name;
+    info->desc = (char*) desc;
+    info->value_ptr = &info->val;
+
+    return info;
+}
+
+// shift flags by one position
+static char * cargs__shift_args(int *argc, char ***argv)
+{
+    assert(*argc > 0);
+
+    char *res = **argv;
+
+    *argc -= 1;
+    *argv += 1;
+
+    return res;
+}
+
+// locale-independent isspace()
+static bool cargs__is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#   define CARGS__SWAR 1
+#else
+#   define CARGS__SWAR 0
+#endif
+
+#if CARGS__SWAR
+// whether all 8 bytes of v (loaded little-endian) are ASCII digits
+static bool cargs__eight_digits(uint64_t v)
+{
+    return ((v & 0xF0F0F0F0F0F0F0F0u) | (((v + 0x0606060606060606u) & 0xF0F0F0F0F0F0F0F0u) >> 4)) == 0x3333333333333333u;
+}
+
+// the value of 8 ASCII digits loaded little-endian, combining pairs, then quads, then halves
+static uint64_t cargs__eight_digits_value(uint64_t v)
+{
+    v = ((v & 0x0F0F0F0F0F0F0F0Fu) * 2561) >> 8;
+    v = ((v & 0x00FF00FF00FF00FFu) * 6553601) >> 16;
+    return ((v & 0x0000FFFF0000FFFFu) * 42949672960001u) >> 32;
+}
+#endif // CARGS__SWAR
+
+// Parses an unsigned integer literal: decimal digits, or digits after a 0x, 0o or 0b prefix, with single
+// '_' separators allowed between digits. Decimal runs are consumed 8 digits at a time where possible.
+// On overflow the remaining digits are still consumed and *overflow is set, mirroring strtoull's ERANGE.
+static enum cargs_errors cargs__parse_magnitude(const char *s, uint64_t *out, bool *overflow)
+{
+    uint64_t base = 10;
+    if (s[0] == '0') {
+        switch (s[1]) {
+            case 'x': case 'X': base = 16; s += 2; break;
+            case 'o': case 'O': base = 8;  s += 2; break;
+            case 'b': case 'B': base = 2;  s += 2; break;
+            default: break;
+        }
+    }
+
+    uint64_t acc = 0;
+    bool digit_expected = true; // at the start and after a separator
+    *overflow = false;
+
+#if CARGS__SWAR
+    const char *end = base == 10 ? s + strlen(s) : s;
+#endif
+
+    for (;;) {
+#if CARGS__SWAR
+        if (base == 10 && end - s >= 8 && !*overflow) {
+            uint64_t chunk;
+            memcpy(&chunk, s, sizeof(chunk));
+            if (cargs__eight_digits(chunk)) {
+                uint64_t v = cargs__eight_digits_value(chunk);
+                if (acc > (UINT64_MAX - v) / 100000000u) {
+                    *overflow = true;
+                } else {
+                    acc = acc * 100000000u + v;
+                }
+                s += 8;
+                digit_expected = false;
+                continue;
+            }
+        }
+#endif
+        char c = *s;
+        if (c == '_') {
+            if (digit_expected) return CARGS_ERROR_INVALID_NUMBER;
+            digit_expected = true;
+            s++;
+            continue;
+        }
+
+        uint64_t d;
+        if (c >= '0' && c <= '9')      d = (uint64_t)(c - '0');
+        else if (c >= 'a' && c <= 'f') d = (uint64_t)(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') d = (uint64_t)(c - 'A' + 10);
+        else break;
+        if (d >= base) break;
+
+        if (acc > (UINT64_MAX - d) / base) {
+            *overflow = true;
+        } else if (!*overflow) {
+            acc = acc * base + d;
+        }
+        digit_expected = false;
+        s++;
+    }
+
+    // the magnitude is stored even for trailing garbage, so callers can rank range errors first
+    *out = acc;
+    if (*s != '\0' || digit_expected) return CARGS_ERROR_INVALID_NUMBER;
+    return CARGS_ERROR_NONE;
+}
+
+// converts a string to a signed integer of specified width and checks if it's within range
+enum cargs_errors cargs_str2int(int64_t *out, const char *s, int64_t min, int64_t max) {
+    if (s[0] == '\0' || cargs__is_space(s[0]))
+        return CARGS_ERROR_INVALID_NUMBER;
+    bool negative = s[0] == '-';
+    if (s[0] == '-' || s[0] == '+') s++;
+
+    uint64_t mag = 0;
+    bool overflow;
+    enum cargs_errors res = cargs__parse_magnitude(s, &mag, &overflow);
+    // like strtoll, a magnitude beyond 64 bits is reported before trailing garbage
+    if (overflow || mag > (uint64_t)INT64_MAX + negative)
+        return negative ? CARGS_ERROR_UNDERFLOW : CARGS_ERROR_OVERFLOW;
+    if (res != CARGS_ERROR_NONE)
+        return res;
+
+    int64_t l = negative ? (int64_t)(0 - mag) : (int64_t)mag;
+    if (min > l || l > max)
+        return CARGS_ERROR_OUT_OF_BOUNDS;
+    *out = l;
+    return CARGS_ERROR_NONE;
+}
+
+// converts a string to an unsigned integer of specified width and checks if it's within range
+enum cargs_errors cargs_str2uint(uint64_t *out, const char *s, uint64_t min, uint64_t max) {
+    if (s[0] == '\0' || cargs__is_space(s[0]))
+        return CARGS_ERROR_INVALID_NUMBER;
+    // negatives never fit an unsigned flag
+    if (s[0] == '-')
+        return CARGS_ERROR_UNDERFLOW;
+    if (s[0] == '+') s++;
+
+    uint64_t u = 0;
+    bool overflow;
+    enum cargs_errors res = cargs__parse_magnitude(s, &u, &overflow);
+    if (overflow)
+        return CARGS_ERROR_OVERFLOW;
+    if (res != CARGS_ERROR_NONE)
+        return res;
+    if (min > u || u > max)
+        return CARGS_ERROR_OUT_OF_BOUNDS;
+    *out = u;
+    return CARGS_ERROR_NONE;
+}
+
+#define CARGS__DECIMAL_DIGITS 800
+
+// An exact decimal 0.d[0]d[1]...d[nd-1] * 10^dp, used for floats the fast paths cannot round correctly.
+// 800 digits suffice for double: halfway cases need at most 767, and dropped digits are remembered in trunc.
+typedef struct cargs__decimal {
+    uint8_t d[CARGS__DECIMAL_DIGITS + 24]; // digit values, with slack for cargs__decimal_lshift
+    int nd;     // digits in use
+    int dp;     // position of the decimal point
+    bool neg;
+    bool trunc; // nonzero digits were dropped past the end of d
+} cargs__decimal;
+
+static void cargs__decimal_trim(cargs__decimal *a)
+{
+    while (a->nd > 0 && a->d[a->nd - 1] == 0) a->nd--;
+    if (a->nd == 0) a->dp = 0;
+}
+
+// a /= 2^k for k <= 60
+static void cargs__decimal_rshift(cargs__decimal *a, unsigned k)
+{
+    int r = 0, w = 0;
+    uint64_t n = 0;
+    for (; (n >> k) == 0; r++) {
+        if (r >= a->nd) {
+            if (n == 0) {
+                a->nd = 0;
+                return;
+            }
+            while ((n >> k) == 0) {
+                n *= 10;
+                r++;
+            }
+            break;
+        }
+        n = n * 10 + a->d[r];
+    }
+    a->dp -= r - 1;
+
+    uint64_t mask = ((uint64_t)1 << k) - 1;
+    for (; r < a->nd; r++) {
+        a->d[w++] = (uint8_t)(n >> k);
+        n = (n & mask) * 10 + a->d[r];
+    }
+    while (n > 0) {
+        uint8_t digit = (uint8_t)(n >> k);
+        if (w < CARGS__DECIMAL_DIGITS) a->d[w++] = digit;
+        else if (digit > 0) a->trunc = true;
+        n = (n & mask) * 10;
+    }
+    a->nd = w;
+    cargs__decimal_trim(a);
+}
+
+// a *= 2^k for k <= 60
+static void cargs__decimal_lshift(cargs__decimal *a, unsigned k)
+{
+    // at least the number of new leading digits; the unused front is moved out afterwards
+    int delta = (int)((k * 1233) >> 12) + 2;
+    int r = a->nd, w = a->nd + delta;
+    uint64_t n = 0;
+    while (--r >= 0) {
+        n += (uint64_t)a->d[r] << k;
+        a->d[--w] = (uint8_t)(n % 10);
+        n /= 10;
+    }
+    while (n > 0) {
+        a->d[--w] = (uint8_t)(n % 10);
+        n /= 10;
+    }
+    delta -= w;
+    memmove(a->d, a->d + w, (size_t)(a->nd + delta));
+    a->nd += delta;
+    a->dp += delta;
+    for (; a->nd > CARGS__DECIMAL_DIGITS; a->nd--) {
+        if (a->d[a->nd - 1] != 0) a->trunc = true;
+    }
+    cargs__decimal_trim(a);
+}
+
+// a *= 2^k
+static void cargs__decimal_shift(cargs__decimal *a, int k)
+{
+    if (a->nd == 0) return;
+    for (; k > 60; k -= 60) cargs__decimal_lshift(a, 60);
+    for (; k < -60; k += 60) cargs__decimal_rshift(a, 60);
+    if (k > 0) cargs__decimal_lshift(a, (unsigned)k);
+    if (k < 0) cargs__decimal_rshift(a, (unsigned)-k);
+}
+
+// a rounded to the nearest integer, ties to even unless dropped digits put it above the tie; needs dp <= 19
+static uint64_t cargs__decimal_round(const cargs__decimal *a)
+{
+    uint64_t n = 0;
+    int i = 0;
+    for (; i < a->dp && i < a->nd; i++) n = n * 10 + a->d[i];
+    for (; i < a->dp; i++) n *= 10;
+    if (a->dp >= 0 && a->dp < a->nd) {
+        if (a->d[a->dp] == 5 && a->dp + 1 == a->nd) {
+            if (a->trunc || (n & 1)) n++;
+        } else if (a->d[a->dp] >= 5) {
+            n++;
+        }
+    }
+    return n;
+}
+
+// Rounds a to the nearest value of a binary format described like <float.h> does (DBL_MANT_DIG, DBL_MIN_EXP,
+// DBL_MAX_EXP), with gradual underflow. The result is *mant * 2^*exp; returns false when it overflows.
+static bool cargs__decimal_to_binary(cargs__decimal *a, int mant_dig, int min_exp, int max_exp, uint64_t *mant, int *exp)
+{
+    // bit counts that take the decimal point towards 0 without losing the leading digit
+    static const uint8_t steps[] = { 1, 3, 6, 9, 13, 16, 19, 23, 26 };
+    *mant = 0;
+    *exp = 0;
+    // 78/256 is just above log10(2), so these bounds are safely past half the smallest subnormal and the largest value
+    if (a->nd == 0 || a->dp < (min_exp - mant_dig) * 78 / 256 - 3) return true;
+    if (a->dp > max_exp * 78 / 256 + 2) return false;
+
+    int e = 0;
+    while (a->dp > 0) {
+        int n = a->dp >= 9 ? 27 : steps[a->dp];
+        cargs__decimal_shift(a, -n);
+        e += n;
+    }
+    while (a->dp < 0 || (a->dp == 0 && a->d[0] < 5)) {
+        int n = -a->dp >= 9 ? 27 : steps[-a->dp];
+        cargs__decimal_shift(a, n);
+        e -= n;
+    }
+    // 0.5 <= a < 1, so the leading bit of the value is 2^(e - 1)
+    e--;
+    if (e < min_exp - 1) {
+        // subnormal: the exponent stays at the minimum and low bits fall off
+        cargs__decimal_shift(a, -(min_exp - 1 - e));
+        e = min_exp - 1;
+    }
+    if (e >= max_exp) return false;
+
+    cargs__decimal_shift(a, mant_dig);
+    uint64_t m = cargs__decimal_round(a);
+    if (m == (uint64_t)1 << mant_dig) {
+        // rounding carried into a new bit
+        m >>= 1;
+        if (++e >= max_exp) return false;
+    }
+    *mant = m;
+    *exp = e - (mant_dig - 1);
+    return true;
+}
+
+// reads the digits and binary exponent of a hexadecimal float after its 0x prefix
+static enum cargs_errors cargs__decimal_scan_hex(cargs__decimal *a, const char *s)
+{
+    uint64_t m = 0;
+    int e = 0;
+    bool digits = false, dot = false, sticky = false;
+    for (;; s++) {
+        unsigned v;
+        if (*s == '.' && !dot) {
+            dot = true;
+            continue;
+        }
+        if (*s >= '0' && *s <= '9')      v = (unsigned)(*s - '0');
+        else if (*s >= 'a' && *s <= 'f') v = (unsigned)(*s - 'a' + 10);
+        else if (*s >= 'A' && *s <= 'F') v = (unsigned)(*s - 'A' + 10);
+        else break;
+        digits = true;
+        // 60 bits are more than any supported format rounds to; the rest only matters as a sticky bit
+        if ((m >> 56) == 0) {
+            m = m * 16 + v;
+            if (dot) e -= 4;
+        } else {
+            sticky |= v != 0;
+            if (!dot) e += 4;
+        }
+    }
+    if (!digits) return CARGS_ERROR_INVALID_NUMBER;
+
+    if (*s == 'p' || *s == 'P') {
+        s++;
+        bool negative = *s == '-';
+        if (*s == '-' || *s == '+') s++;
+        if (*s < '0' || *s > '9') return CARGS_ERROR_INVALID_NUMBER;
+        int p = 0;
+        for (; *s >= '0' && *s <= '9'; s++) {
+            if (p < 100000) p = p * 10 + (*s - '0');
+        }
+        e += negative ? -p : p;
+    }
+    if (*s != '\0') return CARGS_ERROR_INVALID_NUMBER;
+
+    // m * 2^e as a decimal; exponents this far out already overflow or vanish in every format
+    for (; m > 0; m /= 10) a->d[a->nd++] = (uint8_t)(m % 10);
+    for (int i = 0; i < a->nd / 2; i++) {
+        uint8_t t = a->d[i];
+        a->d[i] = a->d[a->nd - 1 - i];
+        a->d[a->nd - 1 - i] = t;
+    }
+    a->dp = a->nd;
+    a->trunc = sticky;
+    cargs__decimal_trim(a);
+    cargs__decimal_shift(a, e < -20000 ? -20000 : e > 20000 ? 20000 : e);
+    return CARGS_ERROR_NONE;
+}
+
+// Reads [+-]digits[.digits][(e|E)[+-]digits] or a 0x hexadecimal float into a, without consulting the locale.
+// Everything else, including nan and inf, is rejected.
+static enum cargs_errors cargs__decimal_scan(cargs__decimal *a, const char *s)
+{
+    a->nd = 0;
+    a->dp = 0;
+    a->trunc = false;
+    a->neg = *s == '-';
+    if (*s == '-' || *s == '+') s++;
+    if (s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) return cargs__decimal_scan_hex(a, s + 2);
+
+    int significant = 0; // digits from the first nonzero one on, including those that did not fit
+    bool digits = false, dot = false;
+    for (;; s++) {
+        if (*s == '.' && !dot) {
+            dot = true;
+            a->dp = significant;
+            continue;
+        }
+        if (*s < '0' || *s > '9') break;
+        digits = true;
+        if (*s == '0' && significant == 0) {
+            a->dp--;
+            continue;
+        }
+        significant++;
+        if (a->nd < CARGS__DECIMAL_DIGITS) a->d[a->nd++] = (uint8_t)(*s - '0');
+        else if (*s != '0') a->trunc = true;
+    }
+    if (!digits) return CARGS_ERROR_INVALID_NUMBER;
+    if (!dot) a->dp = significant;
+
+    if (*s == 'e' || *s == 'E') {
+        s++;
+        bool negative = *s == '-';
+        if (*s == '-' || *s == '+') s++;
+        if (*s < '0' || *s > '9') return CARGS_ERROR_INVALID_NUMBER;
+        int e = 0;
+        for (; *s >= '0' && *s <= '9'; s++) {
+            if (e < 100000) e = e * 10 + (*s - '0');
+        }
+        a->dp += negative ? -e : e;
+    }
+    if (*s != '\0') return CARGS_ERROR_INVALID_NUMBER;
+    cargs__decimal_trim(a);
+    return CARGS_ERROR_NONE;
+}
+
+// Clinger's fast path: when the digits and the power of ten are both exact in the target type, one
+// multiplication or division rounds correctly. It needs arithmetic evaluated in the declared type.
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+#   define CARGS__FAST_FLOAT 1
+#else
+#   define CARGS__FAST_FLOAT 0
+#endif
+
+// the significand and power of ten of a decimal with at most 19 digits
+static bool cargs__decimal_small(const cargs__decimal *a, uint64_t *m, int *e10)
+{
+    if (a->nd > 19 || a->trunc) return false;
+    uint64_t v = 0;
+    for (int i = 0; i < a->nd; i++) v = v * 10 + a->d[i];
+    *m = v;
+    *e10 = a->dp - a->nd;
+    return true;
+}
+
+#if defined(__SIZEOF_INT128__) && (defined(__GNUC__) || defined(__clang__))
+#   define CARGS__INT128 1
+__extension__ typedef unsigned __int128 cargs__u128;
+#else
+#   define CARGS__INT128 0
+#endif
+
+#if CARGS__INT128
+// Rounds m * 2^e, m with its top bit set and sticky when a nonzero remainder lies below it, to a normal value of
+// the format; same format description and result as cargs__decimal_to_binary. Returns false when it overflows.
+static bool cargs__round_normal(uint64_t m, bool sticky, int e, int mant_dig, int max_exp, uint64_t *mant, int *exp)
+{
+    int drop = 64 - mant_dig;
+    uint64_t half = (uint64_t)1 << (drop - 1);
+    uint64_t rest = m & ((half << 1) - 1);
+    uint64_t r = m >> drop;
+    if (rest > half || (rest == half && (sticky || (r & 1)))) r++;
+    e += drop;
+    if (r >> mant_dig) {
+        r >>= 1;
+        e++;
+    }
+    if (e + mant_dig - 1 >= max_exp) return false;
+    *mant = r;
+    *exp = e;
+    return true;
+}
+
+// The exact medium path for up to 19 digits and a power of ten within 1e-27..1e27, where 5^|e10| fits in
+// 64 bits: a 128-bit product, or a quotient carrying 64 extra bits plus a sticky remainder, is rounded once.
+// Returns 1 when converted, -1 on overflow and 0 when the result would be subnormal.
+static int cargs__decimal_medium(uint64_t m, int e10, int mant_dig, int min_exp, int max_exp, uint64_t *mant, int *exp)
+{
+    static const uint64_t pow5[] = {
+        1u, 5u, 25u, 125u, 625u, 3125u, 15625u, 78125u, 390625u, 1953125u, 9765625u, 48828125u, 244140625u,
+        1220703125u, 6103515625u, 30517578125u, 152587890625u, 762939453125u, 3814697265625u, 19073486328125u,
+        95367431640625u, 476837158203125u, 2384185791015625u, 11920928955078125u, 59604644775390625u,
+        298023223876953125u, 1490116119384765625u, 7450580596923828125u
+    };
+    cargs__u128 x;
+    int e = e10; // x * 2^e, once x is normalized below
+    bool sticky = false;
+    if (e10 >= 0) {
+        x = (cargs__u128)m * pow5[e10];
+    } else {
+        int lz = __builtin_clzll(m);
+        cargs__u128 n = (cargs__u128)(m << lz) << 64;
+        x = n / pow5[-e10];
+        sticky = n % pow5[-e10] != 0;
+        e -= 64 + lz;
+    }
+
+    int lz = (uint64_t)(x >> 64) != 0 ? __builtin_clzll((uint64_t)(x >> 64)) : 64 + __builtin_clzll((uint64_t)x);
+    x <<= lz;
+    e += 64 - lz;
+    sticky |= (uint64_t)x != 0;
+    // the leading bit is 2^(e + 63)
+    if (e + 63 < min_exp - 1) return 0;
+    return cargs__round_normal((uint64_t)(x >> 64), sticky, e, mant_dig, max_exp, mant, exp) ? 1 : -1;
+}
+#endif
+
+// The error for s when it overflows the target type. Values that a long double still holds are out of bounds, as
+// when the converters narrowed from strtold(); 63 bits of mantissa decide that except within 2^-63 of LDBL_MAX.
+static enum cargs_errors cargs__overflow_error(const char *s)
+{
+    cargs__decimal a;
+    uint64_t m;
+    int e;
+    cargs__decimal_scan(&a, s);
+    if (cargs__decimal_to_binary(&a, LDBL_MANT_DIG < 63 ? LDBL_MANT_DIG : 63, LDBL_MIN_EXP, LDBL_MAX_EXP, &m, &e))
+        return CARGS_ERROR_OUT_OF_BOUNDS;
+    return a.neg ? CARGS_ERROR_UNDERFLOW : CARGS_ERROR_OVERFLOW;
+}
+
+// converts a string to a correctly rounded double and checks if it's within range
+enum cargs_errors cargs_str2dbl(double *out, const char *s, double min, double max) {
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+    if (s[0] == '\0' || cargs__is_space(s[0]))
+        return CARGS_ERROR_INVALID_NUMBER;
+    cargs__decimal a;
+    enum cargs_errors res = cargs__decimal_scan(&a, s);
+    if (res != CARGS_ERROR_NONE)
+        return res;
+
+    double v;
+    uint64_t m;
+    int e;
+    bool small = cargs__decimal_small(&a, &m, &e);
+#if CARGS__FAST_FLOAT
+    if (small && m <= (uint64_t)1 << 53 && e >= -22 && e <= 22) {
+        v = e < 0 ? (double)m / pow10[-e] : (double)m * pow10[e];
+        goto done;
+    }
+#else
+    (void)pow10;
+#endif
+#if CARGS__INT128
+    if (small && m != 0 && e >= -27 && e <= 27) {
+        int r = cargs__decimal_medium(m, e, DBL_MANT_DIG, DBL_MIN_EXP, DBL_MAX_EXP, &m, &e);
+        if (r < 0)
+            return cargs__overflow_error(s);
+        if (r > 0) {
+            v = ldexp((double)m, e);
+            goto done;
+        }
+    }
+#endif
+    if (!cargs__decimal_to_binary(&a, DBL_MANT_DIG, DBL_MIN_EXP, DBL_MAX_EXP, &m, &e))
+        return cargs__overflow_error(s);
+    v = ldexp((double)m, e);
+
+done:
+    if (a.neg) v = -v;
+    if (min > v || v > max)
+        return CARGS_ERROR_OUT_OF_BOUNDS;
+    *out = v;
+    return CARGS_ERROR_NONE;
+}
+
+// converts a string to a correctly rounded float and checks if it's within range
+enum cargs_errors cargs_str2flt(float *out, const char *s, float min, float max) {
+    static const float pow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+    if (s[0] == '\0' || cargs__is_space(s[0]))
+        return CARGS_ERROR_INVALID_NUMBER;
+    cargs__decimal a;
+    enum cargs_errors res = cargs__decimal_scan(&a, s);
+    if (res != CARGS_ERROR_NONE)
+        return res;
+
+    float v;
+    uint64_t m;
+    int e;
+    bool small = cargs__decimal_small(&a, &m, &e);
+#if CARGS__FAST_FLOAT
+    if (small && m <= (uint64_t)1 << 24 && e >= -10 && e <= 10) {
+        v = e < 0 ? (float)m / pow10[-e] : (float)m * pow10[e];
+        goto done;
+    }
+#else
+    (void)pow10;
+#endif
+    // the results below are exact in float, so going through double does not round twice
+#if CARGS__INT128
+    if (small && m != 0 && e >= -27 && e <= 27) {
+        int r = cargs__decimal_medium(m, e, FLT_MANT_DIG, FLT_MIN_EXP, FLT_MAX_EXP, &m, &e);
+        if (r < 0)
+            return cargs__overflow_error(s);
+        if (r > 0) {
+            v = (float)ldexp((double)m, e);
+            goto done;
+        }
+    }
+#endif
+    if (!cargs__decimal_to_binary(&a, FLT_MANT_DIG, FLT_MIN_EXP, FLT_MAX_EXP, &m, &e))
+        return cargs__overflow_error(s);
+    v = (float)ldexp((double)m, e);
+
+done:
+    if (a.neg) v = -v;
+    if (min > v || v > max)
+        return CARGS_ERROR_OUT_OF_BOUNDS;
+    *out = v;
+    return CARGS_ERROR_NONE;
+}
+
+// converts a string to a long double with the C library and checks if it's within range
+enum cargs_errors cargs_str2float(long double *out, const char *s, long double min, long double max) {
+    char *end;
+    if (s[0] == '\0' || cargs__is_space(s[0]))
+        return CARGS_ERROR_INVALID_NUMBER;
+    errno = 0;
+    long double res = strtold(s, &end);
+    if (errno == ERANGE) {
+        if (res == HUGE_VALL) return CARGS_ERROR_OVERFLOW;
+        if (res == -HUGE_VALL) return CARGS_ERROR_UNDERFLOW;
+    }
+    if (*end != '\0')
+        return CARGS_ERROR_INVALID_NUMBER;
+    // reject "nan", "inf", "-inf" etc. — strtold accepts them without error
+    if (!isfinite(res))
+        return CARGS_ERROR_INVALID_NUMBER;
+    if (min > res || res > max)
+        return CARGS_ERROR_OUT_OF_BOUNDS;
+    *out = res;
+    return CARGS_ERROR_NONE;
+}
+
+static void cargs__set_error(cargs_error *error, enum cargs_errors err, const char *flag, char *value)
+{
+    error->error = err;
+    error->flag = (char *)flag;
+    error->value = value;
+    error->source = NULL;
+    error->line = 0;
+    error->column = 0;
+    error->suggestions = NULL;
+    error->command = NULL;
+}
+
+// Stores the argument at *slot in the next positional at or after the cursor of state and moves the cursor past
+// it. A rest positional keeps the cursor and collects every further argument. While they are adjacent in argv, its
+// items are the slice of argv that holds them. After the first gap its pointers are logged as list values instead,
+// which end up in the list arena like those of a list flag. Each argument costs O(1) and argv is never written.
+// With a rest callback in state, they go to the callback instead.
+static bool cargs__assign_positional(cargs_ctx *ctx, struct cargs__parse_state *state, char **slot, cargs__target_fn target, void *user, cargs_stats *stats, cargs_error *err)
+{
+    char *arg = *slot;
+    uint32_t *cursor = &state->positional;
+    while (*cursor < ctx->count && cargs__flag(ctx, *cursor)->type != CARGS_POSITIONAL) {
+        (*cursor)++;
+    }
+    if (*cursor == ctx->count) {
+        cargs__set_error(err, CARGS_ERROR_UNKNOWN, arg, NULL);
+        return false;
+    }
+    uint32_t i = *cursor;
+    struct cargs__flag_info *info = cargs__info(ctx, i);
+    if (cargs__flag(ctx, i)->list && state->rest != NULL) {
+        state->rest(state->rest_user, arg);
+        state->rest_count++;
+    } else if (cargs__flag(ctx, i)->list) {
+        cargs_list *rest = &info->val.list;
+        union cargs_value item;
+        if (rest->count == 0) {
+            rest->items = slot;
+        } else if (rest->items != NULL && (char **)rest->items + rest->count != slot) {
+            for (size_t k = 0; k < rest->count; ++k) {
+                item.string = ((char **)rest->items)[k];
+                cargs__list_push(ctx, i, &item);
+            }
+            rest->items = NULL;
+        }
+        if (rest->items == NULL) {
+            item.string = arg;
+            cargs__list_push(ctx, i, &item);
+        }
+        rest->count++;
+    } else {
+        void *dst = target != NULL ? target(user, i) : info->value_ptr;
+        *(char **)dst = state->keep ? cargs__stream_keep(ctx, i, arg) : arg;
+        (*cursor)++;
+    }
+    CARGS__COUNT(stats, positionals, 1);
+#ifdef CARGS_STATS
+    if (stats != NULL && ctx->match_fn != NULL) ctx->match_fn(ctx->match_user, cargs__flag(ctx, i)->name, arg);
+#endif
+    return true;
+}
+
+#ifdef CARGS_STATS
+// counts a value of the given type and reports the match to the hook
+static void cargs__count_match(cargs_ctx *ctx, cargs_stats *stats, const struct cargs_flag *flag, const char *value)
+{
+    if (stats == NULL) return;
+    switch (flag->type) {
+        case CARGS_BOOL: stats->bools++; break;
+        case CARGS_INT8: case CARGS_INT16: case CARGS_INT32: case CARGS_INT64: stats->ints++; break;
+        case CARGS_UINT8: case CARGS_UINT16: case CARGS_UINT32: case CARGS_UINT64: case CARGS_SIZE_T: stats->uints++; break;
+        case CARGS_FLOAT: case CARGS_DOUBLE: case CARGS_LONG_DOUBLE: stats->floats++; break;
+        default: stats->strings++; break;
+    }
+    if (ctx->match_fn != NULL) ctx->match_fn(ctx->match_user, flag->name, value);
+}
+#endif
+
+// sets boolean flag i, or appends the value if it is a list
+static void cargs__set_bool(cargs_ctx *ctx, uint32_t i, bool value, cargs__target_fn target, void *user, cargs_stats *stats)
+{
+    struct cargs_flag *flag = cargs__flag(ctx, i);
+    union cargs_value item;
+    void *dst = flag->list ? &item : target != NULL ? target(user, i) : cargs__info(ctx, i)->value_ptr;
+    *(bool *)dst = value;
+    if (flag->list) cargs__list_push(ctx, i, &item);
+#ifdef CARGS_STATS
+    cargs__count_match(ctx, stats, flag, NULL);
+#else
+    (void)stats;
+#endif
+}
+
+// Resolves a token like -abc or -ovalue that is no flag name itself, the way getopt does: leading boolean short
+// flags are set, and the first short flag that takes a value gets the rest of the token (*attached), or the next
+// argument if nothing is left. Returns that flag or the last boolean, which the caller sets, or -1 if a
+// character names no flag.
+static int cargs__lookup_cluster(cargs_ctx *ctx, const char *token, char **attached, cargs__target_fn target, void *user, cargs_stats *stats)
+{
+    char name[3] = { '-', 0, 0 };
+    for (const char *c = token + 1; *c != '\0'; ++c) {
+        name[1] = *c;
+        int i = cargs__lookup_counted(ctx, name, stats);
+        if (i == -1 || cargs__flag(ctx, i)->type == CARGS_POSITIONAL) return -1;
+        if (cargs__flag(ctx, i)->type != CARGS_BOOL) {
+            *attached = c[1] != '\0' ? (char *)(uintptr_t)(c + 1) : NULL;
+            return i;
+        }
+        if (c[1] == '\0') return i;
+        cargs__set_bool(ctx, (uint32_t)i, true, target, user, stats);
+    }
+    return -1;
+}
+
+// lazy conversion: parsing keeps the argument of a numeric flag after a cheap check of its characters, and the
+// first access converts it
+
+static bool cargs__lazy_type(enum cargs_type type)
+{
+    return (type >= CARGS_INT8 && type <= CARGS_LONG_DOUBLE) || type == CARGS_SIZE_T;
+}
+
+// Whether arg only holds characters that a number of the type may contain after its sign and base prefix, so
+// "abc" fails at parse time while "0xabc" is kept; cargs__convert() decides the rest. Hex digits are only allowed
+// after 0x, and b and o only in the prefix.
+static bool cargs__lazy_syntax(enum cargs_type type, const char *arg)
+{
+    bool is_float = type >= CARGS_FLOAT && type <= CARGS_LONG_DOUBLE;
+    if (arg[0] == '-' || arg[0] == '+') arg++;
+    const char *set = is_float ? "0123456789.eE+-" : "0123456789_";
+    if (arg[0] == '0' && (arg[1] == 'x' || arg[1] == 'X')) {
+        // hex floats have a point and a binary exponent, not separators
+        set = is_float ? "0123456789abcdefABCDEF.pP+-" : "0123456789abcdefABCDEF_";
+        arg += 2;
+    } else if (!is_float && arg[0] == '0' && (arg[1] == 'o' || arg[1] == 'O' || arg[1] == 'b' || arg[1] == 'B')) {
+        arg += 2;
+    }
+    return arg[0] != '\0' && arg[strspn(arg, set)] == '\0';
+}
+
+static void cargs__lazy_push(cargs_ctx *ctx, uint32_t i)
+{
+    if (ctx->npending == ctx->pending_cap) {
+        uint32_t cap = ctx->pending_cap ? ctx->pending_cap * 2 : 16;
+        ctx->pending = (uint32_t *)cargs__alloc(ctx, ctx->pending, ctx->pending_cap * sizeof(*ctx->pending), cap * sizeof(*ctx->pending));
+        ctx->pending_cap = cap;
+    }
+    ctx->pending[ctx->npending++] = i;
+}
+
+// converts the pending argument of flag i, if any; false with ctx->err set if it is invalid
+static bool cargs__lazy_convert(cargs_ctx *ctx, uint32_t i)
+{
+    struct cargs__flag_info *info = cargs__info(ctx, i);
+    if (info->raw == NULL) return true;
+    struct cargs_flag *flag = cargs__flag(ctx, i);
+    enum cargs_errors res = cargs__convert(flag->type, info->raw, info->value_ptr);
+    if (res != CARGS_ERROR_NONE) {
+        cargs__set_error(&ctx->err, res, flag->name, info->raw);
+        return false;
+    }
+    info->raw = NULL;
+    return true;
+}
+
+// whether any help flag is set
+static bool cargs__help_set(cargs_ctx *ctx, cargs__target_fn target, void *user)
+{
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->is_help && flag->type == CARGS_BOOL) {
+            void *dst = target != NULL ? target(user, i) : cargs__info(ctx, i)->value_ptr;
+            if (*(bool *)dst) return true;
+        }
+    }
+    return false;
+}
+
+// Parses the arguments argv[0..argc), which continue those parsed into state before, and returns how many it
+// consumed or -1 on errors. With more set, the last argument is only read as the value of the one before it,
+// since the arguments after it are still to come. Otherwise all are consumed, unless ctx has subcommands and one
+// starts at the returned position.
+static int cargs__parse_args(cargs_ctx *ctx, struct cargs__parse_state *state, int argc, char **argv, bool more, cargs__target_fn target, void *user, cargs_stats *stats, cargs_error *err)
+{
+    int total = argc;
+    while (argc > (more ? 1 : 0)) {
+        char *flag_name = cargs__shift_args(&argc, &argv);
+
+        // "--" sentinel: treat all remaining args as positionals
+        if (state->positionals_only) {
+            if (!cargs__assign_positional(ctx, state, argv - 1, target, user, stats, err)) return -1;
+            continue;
+        }
+        if (strcmp(flag_name, "--") == 0) {
+            state->positionals_only = true;
+            continue;
+        }
+
+        // look the token up in the hash index instead of scanning every flag
+        // (positional names are only labels for help output, never matched)
+        int i = cargs__lookup_counted(ctx, flag_name, stats);
+
+        // Otherwise a long flag may carry its value as --name=value and short flags may be written as -ovalue or
+        // clustered as -abc. The value points into the token; argv is not modified.
+        char *attached = NULL;
+        bool split = false;
+        if (i == -1 && flag_name[0] == '-' && flag_name[1] == '-') {
+            char *eq = strchr(flag_name + 2, '=');
+            size_t len = eq != NULL ? (size_t)(eq - flag_name) : strlen(flag_name);
+            if (eq != NULL) {
+                i = cargs__lookup_n(ctx, flag_name, len, stats);
+                attached = eq + 1;
+                split = true;
+            }
+            if (i == -1 && ctx->abbrev) {
+                uint32_t first;
+                i = cargs__lookup_prefix(ctx, flag_name, len, &first, stats);
+                if (i == -2) {
+                    cargs__set_error(err, CARGS_ERROR_AMBIGUOUS, flag_name, NULL);
+                    return -1;
+                }
+            }
+        } else if (i == -1 && flag_name[0] == '-' && flag_name[1] != '\0') {
+            i = cargs__lookup_cluster(ctx, flag_name, &attached, target, user, stats);
+            split = true;
+        }
+
+        if (i == -1 || cargs__flag(ctx, i)->type == CARGS_POSITIONAL) {
+            // If the unknown argument looks like a flag, report error
+            if (cargs__is_flag(flag_name)) {
+                cargs__set_error(err, CARGS_ERROR_UNKNOWN, flag_name, NULL);
+                return -1;
+            }
+            if (ctx->ncommands > 0) {
+                argc++;
+                break;
+            }
+            // Try to assign to a positional argument
+            if (!cargs__assign_positional(ctx, state, argv - 1, target, user, stats, err)) return -1;
+            continue;
+        }
+
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        // errors name the flag as typed, unless the token held more than its name
+        const char *name = split ? flag->name : flag_name;
+
+        if (flag->type == CARGS_BOOL) {
+            // --flag=false; the words are those of config files
+            bool value = true;
+            enum cargs_errors res = attached != NULL ? cargs__config_bool(attached, &value) : CARGS_ERROR_NONE;
+            if (res != CARGS_ERROR_NONE) {
+                cargs__set_error(err, res, name, attached);
+                return -1;
+            }
+            cargs__set_bool(ctx, (uint32_t)i, value, target, user, stats);
+            continue;
+        }
+
+        struct cargs__flag_info *info = cargs__info(ctx, (uint32_t)i);
+        union cargs_value item;
+        void *dst = flag->list ? &item : target != NULL ? target(user, (uint32_t)i) : info->value_ptr;
+        char *arg = attached;
+        if (arg == NULL) {
+            if (argc == 0 || cargs__is_flag(*argv)) {
+                cargs__set_error(err, CARGS_ERROR_NO_VALUE, name, NULL);
+                return -1;
+            }
+            arg = cargs__shift_args(&argc, &argv);
+        }
+        // arguments from a stream are gone once converted, so they are never deferred
+        if (ctx->lazy && target == NULL && !state->keep && !flag->list && cargs__lazy_type(flag->type)) {
+            if (!cargs__lazy_syntax(flag->type, arg)) {
+                cargs__set_error(err, CARGS_ERROR_INVALID_NUMBER, name, arg);
+                return -1;
+            }
+            if (info->raw == NULL) cargs__lazy_push(ctx, (uint32_t)i);
+            info->raw = arg;
+#ifdef CARGS_STATS
+            cargs__count_match(ctx, stats, flag, arg);
+#endif
+            continue;
+        }
+        enum cargs_errors res = cargs__convert(flag->type, arg, dst);
+        if (res != CARGS_ERROR_NONE) {
+            cargs__set_error(err, res, name, arg);
+            return -1;
+        }
+        if (state->keep && flag->type == CARGS_STRING) *(char **)dst = cargs__stream_keep(ctx, (uint32_t)i, arg);
+        if (flag->list) cargs__list_push(ctx, (uint32_t)i, &item);
+#ifdef CARGS_STATS
+        cargs__count_match(ctx, stats, flag, arg);
+#endif
+    }
+    return total - argc;
+}
+
+// the checks after the last argument: unless a help flag is set, every mandatory positional must have been given
+static bool cargs__parse_finish(cargs_ctx *ctx, const struct cargs__parse_state *state, cargs__target_fn target, void *user, cargs_error *err)
+{
+    if (cargs__help_set(ctx, target, user)) return true;
+
+    // Validate mandatory positionals; a rest positional needs at least one argument
+    for (uint32_t i = state->positional; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->type == CARGS_POSITIONAL && flag->mandatory && !(flag->list && (cargs__info(ctx, i)->val.list.count > 0 || state->rest_count > 0))) {
+            cargs__set_error(err, CARGS_ERROR_MISSING_POSITIONAL, flag->name, NULL);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Parses argv against the flags registered in ctx without modifying ctx, so it may run on several
+// threads at once. The value of flag i is written to target(user, i), or to its value_ptr if target is NULL.
+// The only exception are list flags, which append to ctx and therefore cannot be part of a batch.
+// Counters and the match hook are only updated when stats is not NULL.
+// If ctx has subcommands, parsing stops at the first argument that is no flag and *command receives its position
+// in argv; it stays 0 if there is none.
+static bool cargs__parse_core(cargs_ctx *ctx, int argc, char **argv, cargs__target_fn target, void *user, cargs_stats *stats, cargs_error *err, int *command)
+{
+    struct cargs__parse_state state;
+    memset(&state, 0, sizeof(state));
+
+    // the first entry is the program's name
+    int args = argc > 1 ? argc - 1 : 0;
+    CARGS__COUNT(stats, tokens, (uint64_t)args);
+    int used = cargs__parse_args(ctx, &state, args, argv + 1, false, target, user, stats, err);
+    if (used < 0) return false;
+    if (used < args) *command = used + 1;
+    return cargs__parse_finish(ctx, &state, target, user, err);
+}
+
+// abbreviations: long flag names in sorted order, so the flags sharing a prefix form one range
+
+static int cargs__abbrev_cmp(const void *a, const void *b)
+{
+    return strcmp(((const struct cargs__abbrev *)a)->name, ((const struct cargs__abbrev *)b)->name);
+}
+
+// sorts the long flags by name, unless that was already done for the flags registered now
+static void cargs__abbrev_build(cargs_ctx *ctx)
+{
+    if (!ctx->abbrev || ctx->abbrev_built == ctx->count) return;
+
+    if (ctx->abbrev_cap < ctx->count) {
+        if (ctx->abbrev_names != NULL) cargs__alloc(ctx, ctx->abbrev_names, ctx->abbrev_cap * sizeof(*ctx->abbrev_names), 0);
+        ctx->abbrev_names = (struct cargs__abbrev *)cargs__alloc(ctx, NULL, 0, ctx->count * sizeof(*ctx->abbrev_names));
+        ctx->abbrev_cap = ctx->count;
+    }
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if (flag->type == CARGS_POSITIONAL || strncmp(flag->name, "--", 2) != 0 || flag->name[2] == '\0') continue;
+        ctx->abbrev_names[n].name = flag->name;
+        ctx->abbrev_names[n].flag = flag->alias_of != 0 ? flag->alias_of - 1 : i;
+        n++;
+    }
+    qsort(ctx->abbrev_names, n, sizeof(*ctx->abbrev_names), cargs__abbrev_cmp);
+    ctx->abbrev_count = n;
+    ctx->abbrev_built = ctx->count;
+}
+
+// Returns the flag whose long name starts with the first len characters of prefix if there is exactly one, -1 if
+// there is none and -2 if there are several. Names that are aliases of the same flag count once.
+// *first receives the position of the first candidate in abbrev_names.
+static int cargs__lookup_prefix(cargs_ctx *ctx, const char *prefix, size_t len, uint32_t *first, cargs_stats *stats)
+{
+    uint32_t lo = 0, hi = ctx->abbrev_count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        CARGS__COUNT(stats, compares, 1);
+        if (strncmp(ctx->abbrev_names[mid].name, prefix, len) < 0) lo = mid + 1;
+        else hi = mid;
+    }
+    *first = lo;
+
+    if (lo == ctx->abbrev_count || strncmp(ctx->abbrev_names[lo].name, prefix, len) != 0) return -1;
+    uint32_t flag = ctx->abbrev_names[lo].flag;
+    for (uint32_t k = lo + 1; k < ctx->abbrev_count && strncmp(ctx->abbrev_names[k].name, prefix, len) == 0; ++k) {
+        if (ctx->abbrev_names[k].flag != flag) return -2;
+    }
+    return (int)flag;
+}
+
+// list flags: values are logged while parsing and packed into one arena afterwards
+
+static void cargs__list_push(cargs_ctx *ctx, uint32_t i, const union cargs_value *val)
+{
+    if (ctx->list_nitems == ctx->list_items_cap) {
+        uint32_t cap = ctx->list_items_cap ? ctx->list_items_cap * 2 : 64;
+        ctx->list_items = (struct cargs__list_item *)cargs__alloc(ctx, ctx->list_items, ctx->list_items_cap * sizeof(*ctx->list_items), cap * sizeof(*ctx->list_items));
+        ctx->list_items_cap = cap;
+    }
+    struct cargs__list_item *item = &ctx->list_items[ctx->list_nitems++];
+    item->flag = i;
+    item->val = *val;
+}
+
+// Lays out the array of every list flag that has values back to back in list_arena and copies the logged values
+// in, so each list is contiguous and all of them cost a single allocation, which is reused across parses.
+static void cargs__list_build(cargs_ctx *ctx)
+{
+    const size_t align = sizeof(union cargs_value);
+    if (ctx->list_nitems == 0) return;
+
+    // count the values per flag; items doubles as "not placed yet" until the arena is carved up
+    for (uint32_t k = 0; k < ctx->list_nitems; ++k) {
+        cargs_list *list = &cargs__info(ctx, ctx->list_items[k].flag)->val.list;
+        list->count = 0;
+        list->items = NULL;
+    }
+    size_t size = 0;
+    for (uint32_t k = 0; k < ctx->list_nitems; ++k) {
+        uint32_t i = ctx->list_items[k].flag;
+        if (cargs__info(ctx, i)->val.list.count++ == 0) size += align;
+        size += cargs__type_size(cargs__flag(ctx, i)->type);
+    }
+
+    if (size > ctx->list_arena_size) {
+        if (ctx->list_arena != NULL) cargs__alloc(ctx, ctx->list_arena, ctx->list_arena_size, 0);
+        ctx->list_arena = (char *)cargs__alloc(ctx, NULL, 0, size);
+        ctx->list_arena_size = size;
+    }
+
+    size_t used = 0;
+    for (uint32_t k = 0; k < ctx->list_nitems; ++k) {
+        uint32_t i = ctx->list_items[k].flag;
+        cargs_list *list = &cargs__info(ctx, i)->val.list;
+        if (list->items != NULL) continue;
+        list->items = ctx->list_arena + used;
+        used += (list->count * cargs__type_size(cargs__flag(ctx, i)->type) + align - 1) & ~(align - 1);
+        list->count = 0;
+    }
+    for (uint32_t k = 0; k < ctx->list_nitems; ++k) {
+        uint32_t i = ctx->list_items[k].flag;
+        cargs_list *list = &cargs__info(ctx, i)->val.list;
+        size_t type_size = cargs__type_size(cargs__flag(ctx, i)->type);
+        memcpy((char *)list->items + list->count++ * type_size, &ctx->list_items[k].val, type_size);
+    }
+}
+
+// response files: "@path" arguments are replaced by the arguments stored in path
+
+// Loads path as a writable, zero-terminated buffer. Files are mapped privately, so arguments can be terminated
+// and unescaped in place without copying them or touching the file. A file that fills its last page has no
+// spare byte for the terminator and is read instead, as is every file where mmap is unavailable.
+static bool cargs__rsp_load(cargs_ctx *ctx, const char *path, struct cargs__rsp_file *file)
+{
+#if CARGS__MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)st.st_size;
+    long page = sysconf(_SC_PAGESIZE);
+    if (size > 0 && page > 0 && size % (size_t)page != 0) {
+        void *p = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (p == MAP_FAILED) return false;
+        // the rest of the last page reads as zeros, so data[size] already terminates the contents
+        file->data = (char *)p;
+        file->length = size;
+        file->size = size + 1;
+        file->mapped = true;
+        return true;
+    }
+    close(fd);
+#endif
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) return false;
+    size_t cap = 4096, len = 0;
+    char *data = (char *)cargs__alloc(ctx, NULL, 0, cap);
+    for (;;) {
+        len += fread(data + len, 1, cap - 1 - len, f);
+        if (len < cap - 1) break;
+        data = (char *)cargs__alloc(ctx, data, cap, cap * 2);
+        cap *= 2;
+    }
+    bool ok = !ferror(f);
+    fclose(f);
+    if (!ok) {
+        cargs__alloc(ctx, data, cap, 0);
+        return false;
+    }
+    data[len] = '\0';
+    file->data = data;
+    file->length = len;
+    file->size = cap;
+    file->mapped = false;
+    return true;
+}
+
+// the slot for the next loaded file; it counts once rsp_nfiles is incremented
+static struct cargs__rsp_file *cargs__rsp_next(cargs_ctx *ctx)
+{
+    if (ctx->rsp_nfiles == ctx->rsp_files_cap) {
+        uint32_t cap = ctx->rsp_files_cap ? ctx->rsp_files_cap * 2 : 4;
+        ctx->rsp_files = (struct cargs__rsp_file *)cargs__alloc(ctx, ctx->rsp_files, ctx->rsp_files_cap * sizeof(*ctx->rsp_files), cap * sizeof(*ctx->rsp_files));
+        ctx->rsp_files_cap = cap;
+    }
+    return &ctx->rsp_files[ctx->rsp_nfiles];
+}
+
+static void cargs__rsp_unload(cargs_ctx *ctx, struct cargs__rsp_file *file)
+{
+#if CARGS__MMAP
+    if (file->mapped) {
+        munmap(file->data, file->size);
+        return;
+    }
+#endif
+    cargs__alloc(ctx, file->data, file->size, 0);
+}
+
+// unmaps or frees the loaded files; the arrays are kept for the next parse
+static void cargs__rsp_release(cargs_ctx *ctx)
+{
+    for (uint32_t i = 0; i < ctx->rsp_nfiles; ++i) {
+        cargs__rsp_unload(ctx, &ctx->rsp_files[i]);
+    }
+    ctx->rsp_nfiles = 0;
+    ctx->rsp_argc = 0;
+}
+
+// Splits the file named by arg into arguments and pushes them. Whitespace separates arguments, '...' is taken
+// literally, a backslash escapes the next character, and inside "..." it escapes only '"' and '\'.
+static bool cargs__rsp_expand(cargs_ctx *ctx, char *arg, uint32_t depth, bool *expand, cargs_error *err)
+{
+    if (depth >= CARGS_RESPONSE_DEPTH) {
+        cargs__set_error(err, CARGS_ERROR_RESPONSE_FILE, arg, NULL);
+        return false;
+    }
+    if (!cargs__rsp_load(ctx, arg + 1, cargs__rsp_next(ctx))) {
+        cargs__set_error(err, CARGS_ERROR_RESPONSE_FILE, arg, NULL);
+        return false;
+    }
+    // rsp_files may move while nested files are loaded, the contents do not
+    char *r = ctx->rsp_files[ctx->rsp_nfiles++].data;
+
+    for (;;) {
+        while (cargs__is_space(*r)) r++;
+        if (*r == '\0') return true;
+
+        // the unescaped argument is written over the raw one, which is never shorter
+        char *token = r, *w = r;
+        bool at = *r == '@';
+        char quote = 0;
+        for (; *r != '\0'; r++) {
+            char c = *r;
+            if (quote == '\'') {
+                if (c == '\'') quote = 0;
+                else *w++ = c;
+            } else if (c == '\\' && r[1] != '\0' && (quote == 0 || r[1] == '"' || r[1] == '\\')) {
+                *w++ = *++r;
+            } else if (quote == '"') {
+                if (c == '"') quote = 0;
+                else *w++ = c;
+            } else if (c == '\'' || c == '"') {
+                quote = c;
+            } else if (cargs__is_space(c)) {
+                break;
+            } else {
+                *w++ = c;
+            }
+        }
+        if (quote != 0) {
+            cargs__set_error(err, CARGS_ERROR_RESPONSE_FILE, arg, NULL);
+            return false;
+        }
+
+        bool last = *r == '\0';
+        *w = '\0';
+        if (!cargs__rsp_push(ctx, token, at, depth + 1, expand, err)) return false;
+        if (last) return true;
+        r++;
+    }
+}
+
+// Appends arg to ctx->rsp_argv, or the contents of the response file it names when it starts with an unquoted
+// '@'. Expansion stops after a "--" sentinel, like flag parsing does.
+static bool cargs__rsp_push(cargs_ctx *ctx, char *arg, bool at, uint32_t depth, bool *expand, cargs_error *err)
+{
+    if (*expand && at && arg[0] == '@' && arg[1] != '\0') return cargs__rsp_expand(ctx, arg, depth, expand, err);
+    if (strcmp(arg, "--") == 0) *expand = false;
+
+    // one spare entry keeps the array NULL-terminated like a real argv
+    if (ctx->rsp_argc + 1 >= ctx->rsp_argv_cap) {
+        uint32_t cap = ctx->rsp_argv_cap ? ctx->rsp_argv_cap * 2 : 64;
+        ctx->rsp_argv = (char **)cargs__alloc(ctx, ctx->rsp_argv, ctx->rsp_argv_cap * sizeof(*ctx->rsp_argv), cap * sizeof(*ctx->rsp_argv));
+        ctx->rsp_argv_cap = cap;
+    }
+    ctx->rsp_argv[ctx->rsp_argc++] = arg;
+    ctx->rsp_argv[ctx->rsp_argc] = NULL;
+    return true;
+}
+
+// config files: "name = value" lines applied before the command line
+
+// Finds the flag a config key refers to: the key as written, or with "--" or "-" in front, so "jobs = 4" sets
+// --jobs. The prefixed name is built on the stack; keys too long for it only match as written.
+static int cargs__config_lookup(cargs_ctx *ctx, const char *key, size_t len)
+{
+    int i = cargs__lookup(ctx, key);
+    if (i != -1 || len + 3 > 128) return i;
+
+    char name[128] = { '-', '-' };
+    memcpy(name + 2, key, len + 1);
+    if ((i = cargs__lookup(ctx, name)) != -1) return i;
+    return cargs__lookup(ctx, name + 1);
+}
+
+static enum cargs_errors cargs__config_bool(const char *value, bool *dst)
+{
+    static const char *const words[] = { "false", "true", "no", "yes", "off", "on", "0", "1" };
+    for (size_t w = 0; w < sizeof(words) / sizeof(words[0]); ++w) {
+        if (strcmp(value, words[w]) == 0) {
+            *dst = (w & 1) != 0;
+            return CARGS_ERROR_NONE;
+        }
+    }
+    return CARGS_ERROR_INVALID_NUMBER;
+}
+
+static bool cargs__config_error(cargs_error *err, enum cargs_errors code, const char *path, uint32_t line, const char *bol,
+                                const char *at, const char *flag, char *value)
+{
+    cargs__set_error(err, code, flag, value);
+    err->source = path;
+    err->line = line;
+    err->column = line != 0 ? (uint32_t)(at - bol) + 1 : 0;
+    return false;
+}
+
+// converts a config or environment value into flag i, or into target(user, i) if target is not NULL; list flags
+// get it appended
+static enum cargs_errors cargs__config_store(cargs_ctx *ctx, uint32_t i, char *value, cargs__target_fn target, void *user)
+{
+    struct cargs_flag *flag = cargs__flag(ctx, i);
+    union cargs_value item;
+    void *dst = flag->list ? &item : target != NULL ? target(user, i) : cargs__info(ctx, i)->value_ptr;
+    enum cargs_errors res = flag->type == CARGS_BOOL ? cargs__config_bool(value, (bool *)dst)
+                                                     : cargs__convert(flag->type, value, dst);
+    if (res == CARGS_ERROR_NONE && flag->list) cargs__list_push(ctx, i, &item);
+    return res;
+}
+
+static bool cargs__load_config(cargs_ctx *ctx, const char *path)
+{
+    assert(!ctx->parsed && "cargs_load_config: load config files before cargs_parse() so the command line overrides them");
+
+    if (!cargs__rsp_load(ctx, path, cargs__rsp_next(ctx))) {
+        return cargs__config_error(&ctx->err, CARGS_ERROR_CONFIG, path, 0, NULL, NULL, path, NULL);
+    }
+    // like response files, the file stays loaded so string values can point into it
+    return cargs__config_apply(ctx, path, ctx->rsp_files[ctx->rsp_nfiles++].data, NULL, NULL, &ctx->err);
+}
+
+// applies the "name = value" lines of text, the contents of the config file path, which is split in place
+static bool cargs__config_apply(cargs_ctx *ctx, const char *path, char *text, cargs__target_fn target, void *user, cargs_error *err)
+{
+    char *next = text;
+    for (uint32_t line = 1; *next != '\0'; ++line) {
+        char *bol = next;
+        char *eol = bol;
+        while (*eol != '\0' && *eol != '\n') eol++;
+        next = *eol != '\0' ? eol + 1 : eol;
+
+        char *p = bol;
+        while (p < eol && cargs__is_space(*p)) p++;
+        if (p == eol || *p == '#') continue;
+
+        char *key = p;
+        while (p < eol && *p != '=' && !cargs__is_space(*p)) p++;
+        char *key_end = p;
+        while (p < eol && cargs__is_space(*p)) p++;
+        if (p == eol || *p != '=' || key_end == key) {
+            return cargs__config_error(err, CARGS_ERROR_CONFIG, path, line, bol, p, path, NULL);
+        }
+        p++;
+        while (p < eol && cargs__is_space(*p)) p++;
+        char *value = p, *end = eol;
+        while (end > value && cargs__is_space(end[-1])) end--;
+        *key_end = '\0';
+        *end = '\0';
+
+        // "..." keeps surrounding whitespace and a literal '#'; \" and \\ are unescaped in place
+        if (*value == '"') {
+            char *r = value + 1, *w = value;
+            for (; *r != '\0' && *r != '"'; ++r) {
+                if (*r == '\\' && (r[1] == '"' || r[1] == '\\')) r++;
+                *w++ = *r;
+            }
+            if (*r != '"' || r[1] != '\0') {
+                return cargs__config_error(err, CARGS_ERROR_CONFIG, path, line, bol, r, path, NULL);
+            }
+            *w = '\0';
+        }
+
+        int i = cargs__config_lookup(ctx, key, (size_t)(key_end - key));
+        if (i == -1 || cargs__flag(ctx, i)->type == CARGS_POSITIONAL) {
+            return cargs__config_error(err, CARGS_ERROR_UNKNOWN, path, line, bol, key, key, NULL);
+        }
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        enum cargs_errors res = cargs__config_store(ctx, (uint32_t)i, value, target, user);
+        if (res != CARGS_ERROR_NONE) {
+            return cargs__config_error(err, res, path, line, bol, value, flag->name, value);
+        }
+    }
+    return true;
+}
+
+bool cargs_ctx_load_config(cargs_ctx *ctx, const char *path)
+{
+    bool res = cargs__load_config(ctx, path);
+    cargs__list_build(ctx);
+    return res;
+}
+
+// environment variables: bound names and a prefix are matched in one pass over environ
+
+void cargs_ctx_bind_env(cargs_ctx *ctx, const char *name, const char *env)
+{
+    int i = cargs__lookup(ctx, name);
+    if (i != -1) {
+        cargs__info(ctx, i)->env = env;
+        return;
+    }
+    assert(0 && "cargs_bind_env: flag name not found — register the flag before binding it");
+}
+
+bool cargs_ctx_load_env(cargs_ctx *ctx, const char *prefix)
+{
+    assert(!ctx->parsed && "cargs_load_env: load the environment before cargs_parse() so the command line overrides it");
+
+    // index the bound variable names like flag names, so every variable costs one probe
+    uint32_t nbound = 0, cap = 1;
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        if (cargs__info(ctx, i)->env != NULL) nbound++;
+    }
+    while (cap < nbound * 2) cap *= 2;
+    uint32_t *index = NULL;
+    if (nbound > 0) {
+        index = (uint32_t *)cargs__alloc(ctx, NULL, 0, cap * sizeof(*index));
+        memset(index, 0, cap * sizeof(*index));
+        for (uint32_t i = 0; i < ctx->count; ++i) {
+            const char *env = cargs__info(ctx, i)->env;
+            if (env == NULL) continue;
+            uint32_t slot = cargs__hash(env) & (cap - 1);
+            while (index[slot] != 0) slot = (slot + 1) & (cap - 1);
+            index[slot] = i + 1;
+        }
+    }
+
+    size_t plen = prefix != NULL ? strlen(prefix) : 0;
+    bool ok = true;
+    for (char **e = CARGS__ENVIRON; ok && *e != NULL; ++e) {
+        char *eq = strchr(*e, '=');
+        if (eq == NULL) continue;
+        // the name is copied out, since it is only terminated by the '='
+        size_t len = (size_t)(eq - *e);
+        char key[128];
+        if (len >= sizeof(key)) continue;
+        memcpy(key, *e, len);
+        key[len] = '\0';
+
+        int i = -1;
+        if (index != NULL) {
+            for (uint32_t slot = cargs__hash(key) & (cap - 1); index[slot] != 0; slot = (slot + 1) & (cap - 1)) {
+                if (strcmp(cargs__info(ctx, index[slot] - 1)->env, key) == 0) {
+                    i = (int)index[slot] - 1;
+                    break;
+                }
+            }
+        }
+        if (i == -1 && plen > 0 && len > plen && memcmp(key, prefix, plen) == 0) {
+            // MYAPP_DRY_RUN names dry-run, which is looked up like a config key
+            char *name = key + plen;
+            for (char *c = name; *c != '\0'; ++c) {
+                if (*c == '_') *c = '-';
+                else if (*c >= 'A' && *c <= 'Z') *c = (char)(*c - 'A' + 'a');
+            }
+            i = cargs__config_lookup(ctx, name, len - plen);
+        }
+        if (i == -1 || cargs__flag(ctx, i)->type == CARGS_POSITIONAL) continue;
+
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        char *value = eq + 1;
+        enum cargs_errors res = cargs__config_store(ctx, (uint32_t)i, value, NULL, NULL);
+        if (res != CARGS_ERROR_NONE) {
+            cargs__set_error(&ctx->err, res, flag->name, value);
+            ctx->err.source = *e;
+            ok = false;
+        }
+    }
+
+    if (index != NULL) cargs__alloc(ctx, index, cap * sizeof(*index), 0);
+    cargs__list_build(ctx);
+    return ok;
+}
+
+// schema snapshots: a registered flag table serialized with its lookup index, adopted without rehashing
+
+#define CARGS__SNAPSHOT_VERSION 3u
+#define CARGS__SNAPSHOT_NULL UINT32_MAX
+
+struct cargs__snapshot_header {
+    char magic[8];      // "cargsnap"
+    uint32_t version;   // CARGS__SNAPSHOT_VERSION
+    uint32_t abi;       // cargs__snapshot_abi() of the build that wrote it
+    uint32_t size;      // total bytes
+    uint32_t count;     // number of flags
+    uint32_t index_cap; // slots in the index
+    uint32_t records;   // offset of count struct cargs__snapshot_flag
+    uint32_t index;     // offset of the index, laid out exactly like cargs_ctx.index
+    uint32_t strings;   // offset of the string pool, which starts with the schema id
+};
+
+struct cargs__snapshot_flag {
+    union cargs_value def; // string defaults are stored in def_string instead
+    uint32_t name, desc, def_string, env; // string pool offsets, or CARGS__SNAPSHOT_NULL
+    uint32_t hash;
+    uint32_t alias_of;
+    uint8_t type, mandatory, is_help, list;
+};
+
+// Everything a snapshot silently depends on besides the schema: record layout, value sizes, byte order and the
+// hash function the index was built with. A build that differs in any of them rejects the snapshot.
+static uint32_t cargs__snapshot_abi(void)
+{
+    const uint32_t one = 1;
+    uint32_t parts[6];
+    parts[0] = (uint32_t)sizeof(struct cargs__snapshot_flag);
+    parts[1] = (uint32_t)sizeof(union cargs_value);
+    parts[2] = (uint32_t)sizeof(long double) << 8 | (uint32_t)sizeof(size_t);
+    parts[3] = CARGS_TYPE_COUNT;
+    parts[4] = *(const unsigned char *)&one;
+    parts[5] = cargs__hash("cargs");
+
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < sizeof(parts) / sizeof(parts[0]); ++i) {
+        h ^= parts[i];
+        h *= 16777619u;
     }
+    return h;
 }
 
-cargs_error cargs_get_error() {
-    return cargs__err;
+// appends s to the string pool at *used if there is room, and returns its offset either way
+static uint32_t cargs__snapshot_string(char *pool, size_t room, size_t *used, const char *s)
+{
+    if (s == NULL) return CARGS__SNAPSHOT_NULL;
+    size_t len = strlen(s) + 1;
+    uint32_t off = (uint32_t)*used;
+    if (*used + len <= room) memcpy(pool + *used, s, len);
+    *used += len;
+    return off;
 }
 
-void cargs_reset(void)
+size_t cargs_ctx_snapshot(cargs_ctx *ctx, void *buf, size_t size, const char *schema_id)
 {
-    memset(cargs__flags, 0, sizeof(cargs__flags));
-    cargs__count  = 0;
-    cargs__parsed = false;
-    cargs__err.error = CARGS_ERROR_NONE;
-    cargs__err.flag  = NULL;
-    cargs__err.value = NULL;
+    struct cargs__snapshot_header h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, "cargsnap", 8);
+    h.version = CARGS__SNAPSHOT_VERSION;
+    h.abi = cargs__snapshot_abi();
+    h.count = ctx->count;
+    h.index_cap = ctx->index_cap;
+    h.records = (uint32_t)sizeof(h);
+    h.index = h.records + ctx->count * (uint32_t)sizeof(struct cargs__snapshot_flag);
+    h.strings = h.index + ctx->index_cap * (uint32_t)sizeof(uint32_t);
+
+    // the first pass over the strings only measures when buf is too small
+    char *out = (char *)buf;
+    size_t room = size > h.strings ? size - h.strings : 0;
+    char *pool = out + h.strings;
+    size_t used = 0;
+    cargs__snapshot_string(pool, room, &used, schema_id);
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        struct cargs__flag_info *info = cargs__info(ctx, i);
+        struct cargs__snapshot_flag rec;
+        memset(&rec, 0, sizeof(rec));
+        rec.name = cargs__snapshot_string(pool, room, &used, flag->name);
+        rec.desc = cargs__snapshot_string(pool, room, &used, info->desc);
+        rec.def_string = cargs__snapshot_string(pool, room, &used, flag->type == CARGS_STRING ? info->def.string : NULL);
+        rec.env = cargs__snapshot_string(pool, room, &used, info->env);
+        if (flag->type != CARGS_STRING) rec.def = info->def;
+        rec.hash = flag->hash;
+        rec.type = (uint8_t)flag->type;
+        rec.mandatory = flag->mandatory;
+        rec.is_help = flag->is_help;
+        rec.list = flag->list;
+        rec.alias_of = flag->alias_of;
+        if (size >= h.index) memcpy(out + h.records + i * sizeof(rec), &rec, sizeof(rec));
+    }
+    assert(h.strings + used <= UINT32_MAX && "cargs_snapshot: schema too large for a snapshot");
+    h.size = h.strings + (uint32_t)used;
+    if (size < h.size) return h.size;
+
+    memcpy(out, &h, sizeof(h));
+    if (ctx->index_cap > 0) memcpy(out + h.index, ctx->index, ctx->index_cap * sizeof(uint32_t));
+    return h.size;
 }
 
-void cargs_log_options(FILE *stream, bool printdefault)
+// checks everything adoption relies on, so a stale or damaged snapshot is rejected instead of misread
+static bool cargs__snapshot_valid(const char *base, size_t size, const struct cargs__snapshot_header *h, const char *schema_id)
+{
+    if (memcmp(h->magic, "cargsnap", 8) != 0 || h->version != CARGS__SNAPSHOT_VERSION || h->abi != cargs__snapshot_abi()) return false;
+    if (h->size != size || h->records != sizeof(*h)) return false;
+    if ((uint64_t)h->records + (uint64_t)h->count * sizeof(struct cargs__snapshot_flag) != h->index) return false;
+    if ((uint64_t)h->index + (uint64_t)h->index_cap * sizeof(uint32_t) != h->strings) return false;
+    if (h->strings >= size || base[size - 1] != '\0') return false;
+    if ((h->index_cap & (h->index_cap - 1)) != 0 || (uint64_t)h->count * 2 > h->index_cap) return false;
+    if (strcmp(base + h->strings, schema_id) != 0) return false;
+
+    // Lookups probe the index until they reach an empty slot, so it must hold every flag exactly once, in a slot
+    // that probing for the flag's hash reaches: count slots are in use, and each flag is found from its home
+    // slot. Half of the slots stay empty, so every probe ends. Records are checked while they are adopted.
+    uint32_t used = 0;
+    for (uint32_t s = 0; s < h->index_cap; ++s) {
+        uint32_t slot;
+        memcpy(&slot, base + h->index + s * sizeof(slot), sizeof(slot));
+        if (slot > h->count) return false;
+        used += slot != 0;
+    }
+    if (used != h->count) return false;
+    for (uint32_t i = 0; i < h->count; ++i) {
+        uint32_t hash;
+        memcpy(&hash, base + h->records + i * sizeof(struct cargs__snapshot_flag) + offsetof(struct cargs__snapshot_flag, hash), sizeof(hash));
+        for (uint32_t s = hash & (h->index_cap - 1);; s = (s + 1) & (h->index_cap - 1)) {
+            uint32_t slot;
+            memcpy(&slot, base + h->index + s * sizeof(slot), sizeof(slot));
+            if (slot == i + 1) break;
+            if (slot == 0) return false;
+        }
+    }
+    return true;
+}
+
+bool cargs_ctx_adopt(cargs_ctx *ctx, const void *blob, size_t size, const char *schema_id)
+{
+    assert(ctx->count == 0 && !ctx->parsed && "cargs_adopt: adopt a snapshot into an empty context, before registering flags");
+
+    const char *base = (const char *)blob;
+    struct cargs__snapshot_header h;
+    if (size < sizeof(h)) return false;
+    memcpy(&h, base, sizeof(h));
+    if (!cargs__snapshot_valid(base, size, &h, schema_id)) return false;
+
+    if (ctx->index != NULL && !ctx->index_shared) cargs__alloc(ctx, ctx->index, ctx->index_cap * sizeof(*ctx->index), 0);
+    ctx->index = NULL;
+    ctx->index_cap = 0;
+    cargs__grow_chunks(ctx, h.count);
+
+    // the index is used in place; only a misaligned blob (e.g. a C array of bytes) costs a copy
+    const char *pool = base + h.strings;
+    if ((uintptr_t)(base + h.index) % sizeof(uint32_t) == 0) {
+        ctx->index = (uint32_t *)(uintptr_t)(base + h.index);
+        ctx->index_shared = true;
+    } else if (h.index_cap > 0) {
+        ctx->index = (uint32_t *)cargs__alloc(ctx, NULL, 0, h.index_cap * sizeof(uint32_t));
+        memcpy(ctx->index, base + h.index, h.index_cap * sizeof(uint32_t));
+        ctx->index_shared = false;
+    }
+    ctx->index_cap = h.index_cap;
+
+    size_t room = size - h.strings;
+    for (uint32_t i = 0; i < h.count; ++i) {
+        struct cargs__snapshot_flag rec;
+        memcpy(&rec, base + h.records + i * sizeof(rec), sizeof(rec));
+        if (rec.type >= CARGS_TYPE_COUNT || rec.name >= room || (rec.desc != CARGS__SNAPSHOT_NULL && rec.desc >= room) ||
+            (rec.def_string != CARGS__SNAPSHOT_NULL && rec.def_string >= room) || (rec.env != CARGS__SNAPSHOT_NULL && rec.env >= room) ||
+            rec.alias_of > i) {
+            // the flags adopted so far are plain memory; dropping the index leaves the registry empty
+            if (ctx->index != NULL && !ctx->index_shared) cargs__alloc(ctx, ctx->index, ctx->index_cap * sizeof(*ctx->index), 0);
+            ctx->index = NULL;
+            ctx->index_cap = 0;
+            ctx->index_shared = false;
+            return false;
+        }
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        struct cargs__flag_info *info = cargs__info(ctx, i);
+        memset(flag, 0, sizeof(*flag));
+        memset(info, 0, sizeof(*info));
+        flag->type = (enum cargs_type)rec.type;
+        flag->hash = rec.hash;
+        flag->name = pool + rec.name;
+        info->desc = rec.desc != CARGS__SNAPSHOT_NULL ? pool + rec.desc : NULL;
+        info->env = rec.env != CARGS__SNAPSHOT_NULL ? pool + rec.env : NULL;
+        info->def = rec.def;
+        if (flag->type == CARGS_STRING) info->def.string = rec.def_string != CARGS__SNAPSHOT_NULL ? (char *)(uintptr_t)(pool + rec.def_string) : NULL;
+        flag->mandatory = rec.mandatory != 0;
+        flag->is_help = rec.is_help != 0;
+        flag->list = rec.list != 0;
+        info->val = info->def;
+        if (flag->type == CARGS_POSITIONAL) info->val.string = NULL;
+        info->value_ptr = &info->val;
+        // aliases are registered after their flag
+        flag->alias_of = rec.alias_of;
+        if (rec.alias_of != 0) {
+            info->value_ptr = cargs__info(ctx, rec.alias_of - 1)->value_ptr;
+            cargs__info(ctx, rec.alias_of - 1)->alias = flag->name;
+        }
+    }
+    ctx->count = h.count;
+    return true;
+}
+
+bool cargs_ctx_adopt_file(cargs_ctx *ctx, const char *path, const char *schema_id)
+{
+    struct cargs__rsp_file *file = cargs__rsp_next(ctx);
+    if (!cargs__rsp_load(ctx, path, file)) return false;
+    if (!cargs_ctx_adopt(ctx, file->data, file->length, schema_id)) {
+        cargs__rsp_unload(ctx, file);
+        return false;
+    }
+    // the flags point into the file, so it stays loaded until reset like a config file
+    ctx->rsp_nfiles++;
+    return true;
+}
+
+void *cargs_ctx_value(cargs_ctx *ctx, const char *name)
+{
+    int i = cargs__lookup(ctx, name);
+    if (i == -1 || !cargs__lazy_convert(ctx, (uint32_t)i)) return NULL;
+    return cargs__info(ctx, i)->value_ptr;
+}
+
+void cargs_ctx_lazy(cargs_ctx *ctx, bool enable)
+{
+    ctx->lazy = enable;
+}
+
+bool cargs_ctx_validate(cargs_ctx *ctx)
+{
+    // flags converted through cargs_value() since are skipped by cargs__lazy_convert()
+    for (uint32_t k = 0; k < ctx->npending; ++k) {
+        if (!cargs__lazy_convert(ctx, ctx->pending[k])) return false;
+    }
+    ctx->npending = 0;
+    return true;
+}
+
+// size of the value stored for a flag of the given type
+static size_t cargs__type_size(enum cargs_type type)
 {
-    for (uint32_t i = 0; i < cargs__count; ++i) {
+    switch (type) {
+        case CARGS_BOOL:        return sizeof(bool);
+        case CARGS_CHAR:        return sizeof(char);
+        case CARGS_INT8:        return sizeof(int8_t);
+        case CARGS_UINT8:       return sizeof(uint8_t);
+        case CARGS_INT16:       return sizeof(int16_t);
+        case CARGS_UINT16:      return sizeof(uint16_t);
+        case CARGS_INT32:       return sizeof(int32_t);
+        case CARGS_UINT32:      return sizeof(uint32_t);
+        case CARGS_INT64:       return sizeof(int64_t);
+        case CARGS_UINT64:      return sizeof(uint64_t);
+        case CARGS_FLOAT:       return sizeof(float);
+        case CARGS_DOUBLE:      return sizeof(double);
+        case CARGS_LONG_DOUBLE: return sizeof(long double);
+        case CARGS_STRING:      return sizeof(char *);
+        case CARGS_SIZE_T:      return sizeof(size_t);
+        case CARGS_POSITIONAL:  return sizeof(char *);
+        case CARGS_TYPE_COUNT:
+        default:
+            assert(0 && "Unreachable, Unknown Type");
+            return 0;
+    }
+}
 
-		fprintf(stream, "    %s\n", cargs__flags[i].name);
-		fprintf(stream, "          %s\n", cargs__flags[i].desc);
+// converts the value of a non-boolean flag and stores it in dst
+static enum cargs_errors cargs__convert(enum cargs_type type, char *arg, void *dst)
+{
+    enum cargs_errors res = CARGS_ERROR_NONE;
+    int64_t ival;
+    uint64_t uval;
+    long double fval;
+
+    switch (type) {
+        case CARGS_CHAR:
+            // silently taking arg[0] would swallow typos like --flag "ab"
+            if (arg[0] == '\0' || arg[1] != '\0') return CARGS_ERROR_INVALID_NUMBER;
+            *(char *)dst = arg[0];
+            break;
 
-        if (!printdefault) continue;
+        case CARGS_INT8:
+            if ((res = cargs_str2int(&ival, arg, INT8_MIN, INT8_MAX)) == CARGS_ERROR_NONE) *(int8_t *)dst = (int8_t)ival;
+            break;
 
-	switch(cargs__flags[i].type) {
-		case CARGS_BOOL:
-			fprintf(stream, "          Default: %s\n", cargs__flags[i].def.boolean ? "true" : "false");
-			break;
-		case CARGS_POSITIONAL:
-			fprintf(stream, "          %s\n", cargs__flags[i].mandatory ? "Mandatory" : "Optional");
-			break;
-	    case CARGS_CHAR:
-			fprintf(stream, "          Default: %c\n", cargs__flags[i].def.character);
-			break;
+        case CARGS_INT16:
+            if ((res = cargs_str2int(&ival, arg, INT16_MIN, INT16_MAX)) == CARGS_ERROR_NONE) *(int16_t *)dst = (int16_t)ival;
+            break;
 
-		case CARGS_INT8:
-			fprintf(stream, "          Default: %d\n", cargs__flags[i].def.int8);
-			break;
+        case CARGS_INT32:
+            if ((res = cargs_str2int(&ival, arg, INT32_MIN, INT32_MAX)) == CARGS_ERROR_NONE) *(int32_t *)dst = (int32_t)ival;
+            break;
 
-		case CARGS_UINT8:
-			fprintf(stream, "          Default: %u\n", cargs__flags[i].def.uint8);
-			break;
+        case CARGS_INT64:
+            if ((res = cargs_str2int(&ival, arg, INT64_MIN, INT64_MAX)) == CARGS_ERROR_NONE) *(int64_t *)dst = ival;
+            break;
 
-		case CARGS_INT16:
-			fprintf(stream, "          Default: %d\n", cargs__flags[i].def.int16);
-			break;
+        case CARGS_UINT8:
+            if ((res = cargs_str2uint(&uval, arg, 0, UINT8_MAX)) == CARGS_ERROR_NONE) *(uint8_t *)dst = (uint8_t)uval;
+            break;
 
-		case CARGS_UINT16:
-			fprintf(stream, "          Default: %u\n", cargs__flags[i].def.uint16);
-			break;
+        case CARGS_UINT16:
+            if ((res = cargs_str2uint(&uval, arg, 0, UINT16_MAX)) == CARGS_ERROR_NONE) *(uint16_t *)dst = (uint16_t)uval;
+            break;
 
-		case CARGS_INT32:
-			fprintf(stream, "          Default: %d\n", cargs__flags[i].def.int32);
-			break;
+        case CARGS_UINT32:
+            if ((res = cargs_str2uint(&uval, arg, 0, UINT32_MAX)) == CARGS_ERROR_NONE) *(uint32_t *)dst = (uint32_t)uval;
+            break;
 
-		case CARGS_UINT32:
-			fprintf(stream, "          Default: %u\n", cargs__flags[i].def.uint32);
-			break;
+        case CARGS_UINT64:
+            if ((res = cargs_str2uint(&uval, arg, 0, UINT64_MAX)) == CARGS_ERROR_NONE) *(uint64_t *)dst = uval;
+            break;
 
-		case CARGS_INT64:
-			fprintf(stream, "          Default: %" PRId64 "\n", cargs__flags[i].def.int64);
-			break;
+        case CARGS_SIZE_T:
+            if ((res = cargs_str2uint(&uval, arg, 0, SIZE_MAX)) == CARGS_ERROR_NONE) *(size_t *)dst = (size_t)uval;
+            break;
 
-		case CARGS_UINT64:
-			fprintf(stream, "          Default: %" PRIu64 "\n", cargs__flags[i].def.uint64);
-			break;
+        case CARGS_FLOAT:
+            res = cargs_str2flt((float *)dst, arg, -FLT_MAX, FLT_MAX);
+            break;
 
-		case CARGS_FLOAT:
-			fprintf(stream, "          Default: %g\n", cargs__flags[i].def.floating);
-			break;
+        case CARGS_DOUBLE:
+            res = cargs_str2dbl((double *)dst, arg, -DBL_MAX, DBL_MAX);
+            break;
 
-		case CARGS_DOUBLE:
-			fprintf(stream, "          Default: %g\n", cargs__flags[i].def.double_val);
-			break;
+        case CARGS_LONG_DOUBLE:
+            if ((res = cargs_str2float(&fval, arg, -LDBL_MAX, LDBL_MAX)) == CARGS_ERROR_NONE) *(long double *)dst = fval;
+            break;
 
-		case CARGS_LONG_DOUBLE:
-			fprintf(stream, "          Default: %Lg\n", cargs__flags[i].def.long_double);
-			break;
+        case CARGS_STRING:
+            *(char **)dst = arg;
+            break;
 
-		case CARGS_STRING:
-			fprintf(stream, "          Default: %s\n", cargs__flags[i].def.string ? cargs__flags[i].def.string : "(NULL)");
-			break;
+        case CARGS_BOOL:
+        case CARGS_POSITIONAL:
+        case CARGS_TYPE_COUNT:
+        default:
+            assert(0 && "Unreachable, flag type takes no converted value");
+    }
 
-		case CARGS_SIZE_T:
-			fprintf(stream, "          Default: %zu\n", cargs__flags[i].def.size);
-			break;
+    return res;
+}
 
-		case CARGS_TYPE_COUNT:
-		default:
-			assert(0 && "Unreachable, Unknown Type");
-			exit(69);
-			break;
-		}
+static int cargs__is_flag(const char *arg)
+{
+    // bare "-" is a conventional stdin token, not a flag
+    return arg != NULL && arg[0] == '-' && arg[1] != '\0';
+}
 
-	}
+// 32-bit FNV-1a hash of a flag name
+static uint32_t cargs__hash(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
 }
 
+// cargs__hash() of the first len characters of s
+static uint32_t cargs__hash_n(const char *s, size_t len)
+{
+    uint32_t h = 2166136261u;
+    for (size_t k = 0; k < len; ++k) {
+        h ^= (unsigned char)s[k];
+        h *= 16777619u;
+    }
+    return h;
+}
 
-// helper functions
+// returns the index of the flag registered under name, or -1 if there is none
+static int cargs__lookup(cargs_ctx *ctx, const char *name)
+{
+    return cargs__lookup_counted(ctx, name, NULL);
+}
 
-// allocate a new flag on the local stack with provided type, name and description
-static struct cargs_flag *cargs__new(enum cargs_type type, const char *name, const char *desc)
+// cargs__lookup() that counts the lookup, the slots it visits and the names it compares in stats
+static int cargs__lookup_counted(cargs_ctx *ctx, const char *name, cargs_stats *stats)
 {
-    assert(!cargs__parsed && "Flag registered after cargs_parse() was called — register all flags before parsing!");
+    CARGS__COUNT(stats, lookups, 1);
+    if (ctx->index == NULL) return -1;
+
+    uint32_t hash = cargs__hash(name);
+    uint32_t slot = hash & (ctx->index_cap - 1);
+    while (ctx->index[slot] != 0) {
+        struct cargs_flag *flag = cargs__flag(ctx, ctx->index[slot] - 1);
+        CARGS__COUNT(stats, probes, 1);
+        if (flag->hash == hash) {
+            CARGS__COUNT(stats, compares, 1);
+            if (strcmp(flag->name, name) == 0) return (int)(flag->alias_of != 0 ? flag->alias_of : ctx->index[slot]) - 1;
+        }
+        slot = (slot + 1) & (ctx->index_cap - 1);
+    }
+    return -1;
+}
 
-    // Check for duplicate flag name
-    for (uint32_t j = 0; j < cargs__count; ++j) {
-        if (strcmp(cargs__flags[j].name, name) == 0) {
-            assert(0 && "Duplicate flag name!");
+// cargs__lookup_counted() for the first len characters of name, which need not be terminated there
+static int cargs__lookup_n(cargs_ctx *ctx, const char *name, size_t len, cargs_stats *stats)
+{
+    CARGS__COUNT(stats, lookups, 1);
+    if (ctx->index == NULL) return -1;
+
+    uint32_t hash = cargs__hash_n(name, len);
+    uint32_t slot = hash & (ctx->index_cap - 1);
+    while (ctx->index[slot] != 0) {
+        struct cargs_flag *flag = cargs__flag(ctx, ctx->index[slot] - 1);
+        CARGS__COUNT(stats, probes, 1);
+        if (flag->hash == hash) {
+            CARGS__COUNT(stats, compares, 1);
+            if (strncmp(flag->name, name, len) == 0 && flag->name[len] == '\0') {
+                return (int)(flag->alias_of != 0 ? flag->alias_of : ctx->index[slot]) - 1;
+            }
         }
+        slot = (slot + 1) & (ctx->index_cap - 1);
     }
+    return -1;
+}
 
-    assert(cargs__count < CARGS_MAX_FLAGS && "To many flags! Define #CARGS_MAX_FLAGS to be a bigger number!");
+// returns the chunk holding flag i; chunk k starts at index CARGS_CHUNK_FLAGS * (2^k - 1)
+static uint32_t cargs__chunk(uint32_t i)
+{
+    uint32_t n = i / CARGS_CHUNK_FLAGS + 1;
+    uint32_t k = 0;
+#if defined(__GNUC__) || defined(__clang__)
+    k = 31 - (uint32_t)__builtin_clz(n);
+#else
+    while (n >>= 1) k++;
+#endif
+    return k;
+}
 
-    struct cargs_flag *flag = &cargs__flags[cargs__count++];
-    memset(flag, 0, sizeof(*flag));
+// returns the flag with index i
+static struct cargs_flag *cargs__flag(cargs_ctx *ctx, uint32_t i)
+{
+    uint32_t k = cargs__chunk(i);
+    return &ctx->chunks[k][i - CARGS_CHUNK_FLAGS * ((1u << k) - 1)];
+}
 
-    flag->type  = type;
-    flag->name = (char*) name;
-    flag->desc = (char*) desc;
-    flag->value_ptr = &flag->val;
+// returns the info of the flag with index i
+static struct cargs__flag_info *cargs__info(cargs_ctx *ctx, uint32_t i)
+{
+    uint32_t k = cargs__chunk(i);
+    return &ctx->infos[k][i - CARGS_CHUNK_FLAGS * ((1u << k) - 1)];
+}
 
-    return flag;
+static void *cargs__default_alloc(void *user, void *ptr, size_t old_size, size_t new_size)
+{
+    (void)user;
+    (void)old_size;
+    if (new_size == 0) {
+        free(ptr);
+        return NULL;
+    }
+    return realloc(ptr, new_size);
 }
 
-// shift flags by one position
-static char * cargs__shift_args(int *argc, char ***argv)
+static void *cargs__alloc(cargs_ctx *ctx, void *ptr, size_t old_size, size_t new_size)
 {
-    assert(*argc > 0);
+    cargs_alloc_fn fn = ctx->alloc_fn != NULL ? ctx->alloc_fn : cargs__default_alloc;
+    void *res = fn(ctx->alloc_user, ptr, old_size, new_size);
+    if (res == NULL && new_size != 0) {
+        assert(0 && "cargs: allocation failed!");
+        abort();
+    }
+    return res;
+}
 
-    char *res = **argv;
+// adds chunks until nflags flags fit
+static void cargs__grow_chunks(cargs_ctx *ctx, uint32_t nflags)
+{
+    while (ctx->capacity < nflags) {
+        assert(ctx->nchunks < CARGS__MAX_CHUNKS);
+        size_t n = (size_t)CARGS_CHUNK_FLAGS << ctx->nchunks;
+        ctx->chunks[ctx->nchunks] = (struct cargs_flag *)cargs__alloc(ctx, NULL, 0, n * sizeof(struct cargs_flag));
+        ctx->infos[ctx->nchunks++] = (struct cargs__flag_info *)cargs__alloc(ctx, NULL, 0, n * sizeof(struct cargs__flag_info));
+        ctx->capacity += (uint32_t)n;
+    }
+}
 
-    *argc -= 1;
-    *argv += 1;
+// makes room for nflags flags: adds chunks and rehashes the index once it would become more than half full,
+// or before the first change to an index borrowed from a snapshot
+static void cargs__grow(cargs_ctx *ctx, uint32_t nflags)
+{
+    cargs__grow_chunks(ctx, nflags);
+
+    if ((uint64_t)nflags * 2 <= ctx->index_cap && !ctx->index_shared) return;
+
+    uint32_t cap = ctx->index_cap ? ctx->index_cap : CARGS_CHUNK_FLAGS * 2;
+    while ((uint64_t)nflags * 2 > cap) cap *= 2;
+
+    uint32_t *index = (uint32_t *)cargs__alloc(ctx, NULL, 0, cap * sizeof(*index));
+    memset(index, 0, cap * sizeof(*index));
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        uint32_t slot = cargs__flag(ctx, i)->hash & (cap - 1);
+        while (index[slot] != 0) slot = (slot + 1) & (cap - 1);
+        index[slot] = i + 1;
+    }
+    if (ctx->index != NULL && !ctx->index_shared) cargs__alloc(ctx, ctx->index, ctx->index_cap * sizeof(*ctx->index), 0);
+    ctx->index = index;
+    ctx->index_cap = cap;
+    ctx->index_shared = false;
+}
+// streaming: the stream is split into arguments in a fixed buffer and fed to the parse loop a window at a time
+
+// copies arg into the string kept for flag i, which replaces its previous value from the stream
+static char *cargs__stream_keep(cargs_ctx *ctx, uint32_t i, const char *arg)
+{
+    if (ctx->stream_values == NULL) {
+        ctx->stream_values = (struct cargs__stream_value *)cargs__alloc(ctx, NULL, 0, ctx->count * sizeof(*ctx->stream_values));
+        memset(ctx->stream_values, 0, ctx->count * sizeof(*ctx->stream_values));
+        ctx->stream_nvalues = ctx->count;
+    }
+    struct cargs__stream_value *value = &ctx->stream_values[i];
+    size_t len = strlen(arg) + 1;
+    if (value->size < len) {
+        if (value->text != NULL) cargs__alloc(ctx, value->text, value->size, 0);
+        value->text = (char *)cargs__alloc(ctx, NULL, 0, len);
+        value->size = len;
+    }
+    memcpy(value->text, arg, len);
+    return value->text;
+}
+
+// arguments handed to the parse loop at once
+#define CARGS__STREAM_WINDOW 64
+
+static bool cargs__parse_stream(cargs_ctx *ctx, int argc, char **argv, cargs_read_fn read, void *read_user, char delim, cargs_rest_fn rest, void *rest_user)
+{
+    // a subcommand would parse the rest of the stream with a context of its own, a repeatable string flag would
+    // keep every value, and a rest slice would point into the read buffer
+    if (ctx->ncommands > 0) {
+        cargs__set_error(&ctx->err, CARGS_ERROR_STREAM, ctx->commands[0].name, NULL);
+        return false;
+    }
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        struct cargs_flag *flag = cargs__flag(ctx, i);
+        if ((flag->list && flag->type == CARGS_STRING) || (flag->list && flag->type == CARGS_POSITIONAL && rest == NULL)) {
+            cargs__set_error(&ctx->err, CARGS_ERROR_STREAM, flag->name, NULL);
+            return false;
+        }
+    }
+    if (!cargs__parse_start(ctx, &argc, &argv)) return false;
+    cargs__abbrev_build(ctx);
+
+    struct cargs__parse_state state;
+    memset(&state, 0, sizeof(state));
+    state.rest = rest;
+    state.rest_user = rest_user;
+    int args = argc > 1 ? argc - 1 : 0;
+    CARGS__COUNT(&ctx->stats, tokens, (uint64_t)args);
+    bool res = cargs__parse_args(ctx, &state, args, argv + 1, false, NULL, NULL, &ctx->stats, &ctx->err) >= 0;
+
+    // buf[0..len) holds what was read and not consumed yet; arguments end at scan, and the window points to the
+    // ones not parsed yet. The window is parsed once it holds two or more arguments, keeping the last one back
+    // as the possible value of a flag, and the buffer is refilled once it holds no further complete argument.
+    if (ctx->stream_buf == NULL) ctx->stream_buf = (char *)cargs__alloc(ctx, NULL, 0, CARGS_STREAM_BUFFER + 1);
+    char *buf = ctx->stream_buf;
+    char *window[CARGS__STREAM_WINDOW];
+    size_t len = 0, scan = 0;
+    int n = 0;
+    uint32_t read_args = 0;
+    bool end = false;
+    state.keep = true;
+    while (res) {
+        while (n < CARGS__STREAM_WINDOW && scan < len) {
+            char *d = (char *)memchr(buf + scan, delim, len - scan);
+            if (d == NULL && !end) break;
+            // a last argument without delimiter is terminated in the spare byte
+            if (d == NULL) d = buf + len;
+            *d = '\0';
+            window[n++] = buf + scan;
+            scan = (size_t)(d - buf) + 1;
+            read_args++;
+        }
+        bool last = end && scan >= len;
+        if (n > 1 || last) {
+            int used = cargs__parse_args(ctx, &state, n, window, !last, NULL, NULL, &ctx->stats, &ctx->err);
+            if (used < 0) {
+                res = false;
+                break;
+            }
+            CARGS__COUNT(&ctx->stats, tokens, (uint64_t)used);
+            if (last) break;
+            n -= used;
+            memmove(window, window + used, (size_t)n * sizeof(*window));
+            continue;
+        }
+
+        // move the unparsed argument and the incomplete one to the front, then read behind them
+        bool in_buf = n > 0 && window[0] != ctx->stream_held;
+        size_t from = in_buf ? (size_t)(window[0] - buf) : scan;
+        if (in_buf && len - from == CARGS_STREAM_BUFFER) {
+            // together they fill the buffer: the unparsed one moves out, so only a single argument can be too long
+            size_t size = scan - from;
+            if (ctx->stream_held_size < size) {
+                if (ctx->stream_held != NULL) cargs__alloc(ctx, ctx->stream_held, ctx->stream_held_size, 0);
+                ctx->stream_held = (char *)cargs__alloc(ctx, NULL, 0, size);
+                ctx->stream_held_size = size;
+            }
+            memcpy(ctx->stream_held, window[0], size);
+            window[0] = ctx->stream_held;
+            in_buf = false;
+            from = scan;
+        }
+        memmove(buf, buf + from, len - from);
+        if (in_buf) window[0] -= from;
+        len -= from;
+        scan -= from;
+        if (len == CARGS_STREAM_BUFFER) {
+            cargs__set_error(&ctx->err, CARGS_ERROR_STREAM, NULL, NULL);
+            ctx->err.line = read_args + 1;
+            res = false;
+            break;
+        }
+        long got = read(read_user, buf + len, CARGS_STREAM_BUFFER - len);
+        if (got < 0) {
+            cargs__set_error(&ctx->err, CARGS_ERROR_STREAM, NULL, NULL);
+            res = false;
+            break;
+        }
+        end = got == 0;
+        len += (size_t)got;
+    }
 
+    if (res) res = cargs__parse_finish(ctx, &state, NULL, NULL, &ctx->err);
+    cargs__parse_done(ctx);
     return res;
 }
 
-// converts a string to a signed integer of specified width and checks if it's within range
-static enum cargs_errors cargs__str2int_generic(int64_t *out, char *s, int64_t min, int64_t max) {
-    char *end;
-    if (s[0] == '\0' || isspace(s[0]))
-        return CARGS_ERROR_INVALID_NUMBER;
-    errno = 0;
-    long long l = strtoll(s, &end, 10);
-    if (errno == ERANGE) {
-        if (l == LLONG_MAX) return CARGS_ERROR_OVERFLOW;
-        if (l == LLONG_MIN) return CARGS_ERROR_UNDERFLOW;
+bool cargs_ctx_parse_stream(cargs_ctx *ctx, int argc, char **argv, cargs_read_fn read, void *read_user, char delim, cargs_rest_fn rest, void *rest_user)
+{
+#ifdef CARGS_STATS
+    uint64_t start = cargs__now_ns();
+    bool res = cargs__parse_stream(ctx, argc, argv, read, read_user, delim, rest, rest_user);
+    ctx->stats.parses++;
+    ctx->stats.parse_ns += cargs__now_ns() - start;
+    return res;
+#else
+    return cargs__parse_stream(ctx, argc, argv, read, read_user, delim, rest, rest_user);
+#endif
+}
+
+static long cargs__read_fd(void *user, char *buf, size_t size)
+{
+    int fd = *(int *)user;
+#if CARGS__MMAP
+    for (;;) {
+        ssize_t n = read(fd, buf, size);
+        if (n >= 0 || errno != EINTR) return (long)n;
     }
-    if (*end != '\0')
-        return CARGS_ERROR_INVALID_NUMBER;
-    if (min > l || l > max)
-        return CARGS_ERROR_OUT_OF_BOUNDS;
-    *out = l;
-    return CARGS_ERROR_NONE;
+#elif defined(_WIN32)
+    return _read(fd, buf, size > INT_MAX ? INT_MAX : (unsigned)size);
+#else
+    (void)fd; (void)buf; (void)size;
+    return -1;
+#endif
 }
 
-// converts a string to an unsigned integer of specified width and checks if it's within range
-static enum cargs_errors cargs__str2uint_generic(uint64_t *out, char *s, uint64_t min, uint64_t max) {
-    char *end;
-    if (s[0] == '\0' || isspace(s[0]))
-        return CARGS_ERROR_INVALID_NUMBER;
-    // strtoull wraps negatives silently (no ERANGE, valid *end) — catch explicitly
-    if (s[0] == '-')
-        return CARGS_ERROR_UNDERFLOW;
-    errno = 0;
-    unsigned long long u = strtoull(s, &end, 10);
-    if (errno == ERANGE)
-        return CARGS_ERROR_OVERFLOW;
-    if (*end != '\0')
-        return CARGS_ERROR_INVALID_NUMBER;
-    if (min > u || u > max)
-        return CARGS_ERROR_OUT_OF_BOUNDS;
-    *out = u;
-    return CARGS_ERROR_NONE;
+bool cargs_ctx_parse_fd(cargs_ctx *ctx, int argc, char **argv, int fd, char delim, cargs_rest_fn rest, void *rest_user)
+{
+    return cargs_ctx_parse_stream(ctx, argc, argv, cargs__read_fd, &fd, delim, rest, rest_user);
 }
 
-// converts a string to a float and checks if it's within range
-static enum cargs_errors cargs__str2float_generic(long double *out, char *s, long double min, long double max) {
-    char *end;
-    if (s[0] == '\0' || isspace(s[0]))
-        return CARGS_ERROR_INVALID_NUMBER;
-    errno = 0;
-    long double res = strtold(s, &end);
-    if (errno == ERANGE) {
-        if (res == HUGE_VALL) return CARGS_ERROR_OVERFLOW;
-        if (res == -HUGE_VALL) return CARGS_ERROR_UNDERFLOW;
+// shell completion
+
+// one candidate line; tabs and newlines in the description become spaces
+static void cargs__complete_line(const char *name, const char *desc)
+{
+    fputs(name, stdout);
+    fputc('\t', stdout);
+    for (const char *c = desc != NULL ? desc : ""; *c != '\0'; ++c) {
+        fputc(*c == '\n' || *c == '\t' ? ' ' : *c, stdout);
     }
-    if (*end != '\0')
-        return CARGS_ERROR_INVALID_NUMBER;
-    // reject "nan", "inf", "-inf" etc. — strtold accepts them without error
-    if (!isfinite(res))
-        return CARGS_ERROR_INVALID_NUMBER;
-    if (min > res || res > max)
-        return CARGS_ERROR_OUT_OF_BOUNDS;
-    *out = res;
-    return CARGS_ERROR_NONE;
+    fputc('\n', stdout);
 }
 
-static void cargs__set_error(enum cargs_errors err, const char *flag, char *value)
+bool cargs_ctx_complete(cargs_ctx *ctx, int argc, char **argv)
 {
-    cargs__err.error = err;
-    cargs__err.flag = (char *)flag;
-    cargs__err.value = value;
+    if (argc < 3 || strcmp(argv[1], "__cargs_complete") != 0) return false;
+    uint64_t index;
+    if (cargs_str2uint(&index, argv[2], 0, INT_MAX) != CARGS_ERROR_NONE) return true;
+    char **words = argv + 3;
+    int nwords = argc - 3;
+    const char *cur = (int)index < nwords ? words[index] : "";
+
+    // Replay the words before the cursor: the hash index tells which flags take the next word as their value,
+    // and a subcommand registers its flags just like cargs_parse() would.
+    int value_of = -1;
+    bool positionals_only = false;
+    for (int w = 1; w < (int)index && w < nwords; ++w) {
+        const char *word = words[w];
+        if (value_of != -1) {
+            // bash splits --name=value into three words
+            if (strcmp(word, "=") != 0) value_of = -1;
+            continue;
+        }
+        if (positionals_only) continue;
+        if (strcmp(word, "--") == 0) {
+            positionals_only = true;
+        } else if (cargs__is_flag(word)) {
+            int i = cargs__lookup(ctx, word);
+            if (i != -1 && cargs__flag(ctx, i)->type != CARGS_BOOL && cargs__flag(ctx, i)->type != CARGS_POSITIONAL) value_of = i;
+        } else if (ctx->ncommands > 0 && ctx->command == 0) {
+            int k = cargs__find_command(ctx, word);
+            if (k == -1) return true;
+            ctx = cargs__select_command(ctx, (uint32_t)k);
+        }
+    }
+
+    if (value_of != -1) {
+        if (cargs__flag(ctx, value_of)->type == CARGS_STRING) fputs(":files\n", stdout);
+        return true;
+    }
+    size_t len = strlen(cur);
+    if (cur[0] == '-' && !positionals_only) {
+        for (uint32_t i = 0; i < ctx->count; ++i) {
+            struct cargs_flag *flag = cargs__flag(ctx, i);
+            if (flag->type != CARGS_POSITIONAL && strncmp(flag->name, cur, len) == 0) cargs__complete_line(flag->name, cargs__info(ctx, i)->desc);
+        }
+        return true;
+    }
+    if (ctx->ncommands > 0 && ctx->command == 0 && !positionals_only) {
+        for (uint32_t k = 0; k < ctx->ncommands; ++k) {
+            if (strncmp(ctx->commands[k].name, cur, len) == 0) cargs__complete_line(ctx->commands[k].name, ctx->commands[k].desc);
+        }
+        return true;
+    }
+    for (uint32_t i = 0; i < ctx->count; ++i) {
+        if (cargs__flag(ctx, i)->type == CARGS_POSITIONAL) {
+            fputs(":files\n", stdout);
+            break;
+        }
+    }
+    return true;
 }
 
-static int cargs__find_next_positional()
+// The scripts only adapt the query to each shell: they pass the words, turn candidates into the shell's
+// format and fall back to file names on ":files". %1$s is the program, %2$s a function name derived from it.
+static const char cargs__bash_script[] =
+    "# bash completion for %1$s, generated by cargs\n"
+    "%2$s() {\n"
+    "    local line cur=${COMP_WORDS[COMP_CWORD]}\n"
+    "    [[ $cur == = ]] && cur=\n"
+    "    COMPREPLY=()\n"
+    "    while IFS= read -r line; do\n"
+    "        if [[ $line == :files ]]; then\n"
+    "            COMPREPLY+=($(compgen -f -- \"$cur\"))\n"
+    "        else\n"
+    "            COMPREPLY+=(\"${line%%%%$'\\t'*}\")\n"
+    "        fi\n"
+    "    done < <(\"${COMP_WORDS[0]}\" __cargs_complete \"$COMP_CWORD\" \"${COMP_WORDS[@]}\" 2>/dev/null)\n"
+    "}\n"
+    "complete -o filenames -F %2$s %1$s\n";
+
+static const char cargs__zsh_script[] =
+    "#compdef %1$s\n"
+    "# zsh completion for %1$s, generated by cargs\n"
+    "%2$s() {\n"
+    "    local line files=0\n"
+    "    local -a candidates\n"
+    "    for line in \"${(@f)$(${words[1]} __cargs_complete $((CURRENT - 1)) \"${words[@]}\" 2>/dev/null)}\"; do\n"
+    "        if [[ $line == :files ]]; then\n"
+    "            files=1\n"
+    "        elif [[ -n $line ]]; then\n"
+    "            candidates+=(\"${${line%%%%$'\\t'*}//:/\\\\:}:${line#*$'\\t'}\")\n"
+    "        fi\n"
+    "    done\n"
+    "    (( ${#candidates} )) && _describe 'argument' candidates\n"
+    "    (( files )) && _files\n"
+    "    return 0\n"
+    "}\n"
+    "if [[ $funcstack[1] == %2$s ]]; then %2$s \"$@\"; else compdef %2$s %1$s; fi\n";
+
+static const char cargs__fish_script[] =
+    "# fish completion for %1$s, generated by cargs\n"
+    "function %2$s\n"
+    "    set -l words (commandline -opc) (commandline -ct)\n"
+    "    for line in ($words[1] __cargs_complete (math (count $words) - 1) $words 2>/dev/null)\n"
+    "        if test \"$line\" = :files\n"
+    "            __fish_complete_path (commandline -ct)\n"
+    "        else\n"
+    "            echo $line\n"
+    "        end\n"
+    "    end\n"
+    "end\n"
+    "complete -c %1$s -f -a '(%2$s)'\n";
+
+bool cargs_completion_script(FILE *stream, const char *shell, const char *prog)
 {
-    for (uint32_t i = 0; i < cargs__count; ++i) {
-        if (cargs__flags[i].type == CARGS_POSITIONAL && cargs__flags[i].val.string == NULL) {
-            return i;
+    const char *script;
+    if (strcmp(shell, "bash") == 0) script = cargs__bash_script;
+    else if (strcmp(shell, "zsh") == 0) script = cargs__zsh_script;
+    else if (strcmp(shell, "fish") == 0) script = cargs__fish_script;
+    else return false;
+
+    // a shell identifier: _<prog>_cargs with everything but letters, digits and '_' replaced
+    char function[64] = "_";
+    size_t n = 1;
+    for (const char *c = prog; *c != '\0' && n < sizeof(function) - 7; ++c) {
+        bool word = (*c >= 'a' && *c <= 'z') || (*c >= 'A' && *c <= 'Z') || (*c >= '0' && *c <= '9') || *c == '_';
+        function[n++] = word ? *c : '_';
+    }
+    memcpy(function + n, "_cargs", 7);
+
+    // the scripts refer to the program and function several times; positional arguments keep them readable
+    for (const char *s = script; *s != '\0'; ++s) {
+        if (s[0] == '%' && s[1] == '%') {
+            fputc('%', stream);
+            s++;
+        } else if (s[0] == '%' && (s[1] == '1' || s[1] == '2') && s[2] == '$' && s[3] == 's') {
+            fputs(s[1] == '1' ? prog : function, stream);
+            s += 3;
+        } else {
+            fputc(*s, stream);
         }
     }
-    return -1;
+    return true;
 }
 
-static int cargs__is_flag(const char *arg)
+// getopt shim
+
+char *cargs_optarg = NULL;
+int cargs_optind = 1;
+int cargs_opterr = 1;
+int cargs_optopt = '?';
+
+// Tables derived from the last optstring and longopts, and the position inside a cluster of short options.
+static struct {
+    const char *optstring;
+    unsigned char shorts[256]; // 0 unknown, otherwise 1 + has_arg
+    const cargs_option *longopts;
+    uint32_t *index;           // 1 + position in longopts, by hash of the name, open addressing
+    uint32_t index_cap;
+    char *next;                // the rest of a cluster like -abc, NULL between arguments
+} cargs__getopt_state;
+
+static void cargs__getopt_tables(const char *optstring, const cargs_option *longopts)
 {
-    // bare "-" is a conventional stdin token, not a flag
-    return arg != NULL && arg[0] == '-' && arg[1] != '\0';
+    if (optstring != cargs__getopt_state.optstring) {
+        memset(cargs__getopt_state.shorts, 0, sizeof(cargs__getopt_state.shorts));
+        for (const unsigned char *c = (const unsigned char *)optstring; *c != '\0'; ++c) {
+            if (*c == ':' || *c == '+' || *c == '-') continue;
+            int has_arg = c[1] != ':' ? CARGS_NO_ARGUMENT : c[2] != ':' ? CARGS_REQUIRED_ARGUMENT : CARGS_OPTIONAL_ARGUMENT;
+            cargs__getopt_state.shorts[*c] = (unsigned char)(1 + has_arg);
+        }
+        cargs__getopt_state.optstring = optstring;
+    }
+
+    if (longopts == cargs__getopt_state.longopts) return;
+    uint32_t n = 0, cap = 16;
+    while (longopts != NULL && longopts[n].name != NULL) n++;
+    while (cap < n * 2) cap *= 2;
+    if (cap > cargs__getopt_state.index_cap) {
+        cargs__getopt_state.index = (uint32_t *)cargs__default_alloc(NULL, cargs__getopt_state.index, cargs__getopt_state.index_cap * sizeof(uint32_t), cap * sizeof(uint32_t));
+        cargs__getopt_state.index_cap = cap;
+    }
+    cap = cargs__getopt_state.index_cap;
+    memset(cargs__getopt_state.index, 0, cap * sizeof(uint32_t));
+    for (uint32_t k = 0; k < n; ++k) {
+        uint32_t slot = cargs__hash(longopts[k].name) & (cap - 1);
+        while (cargs__getopt_state.index[slot] != 0) slot = (slot + 1) & (cap - 1);
+        cargs__getopt_state.index[slot] = k + 1;
+    }
+    cargs__getopt_state.longopts = longopts;
+}
+
+// position of the long option named by the first len characters of name: exact, else a unique prefix;
+// -1 if there is none and -2 if the prefix fits several options that differ
+static int cargs__getopt_find(const cargs_option *longopts, const char *name, size_t len)
+{
+    uint32_t cap = cargs__getopt_state.index_cap;
+    uint32_t slot = cargs__hash_n(name, len) & (cap - 1);
+    while (cargs__getopt_state.index[slot] != 0) {
+        const char *other = longopts[cargs__getopt_state.index[slot] - 1].name;
+        if (strncmp(other, name, len) == 0 && other[len] == '\0') return (int)cargs__getopt_state.index[slot] - 1;
+        slot = (slot + 1) & (cap - 1);
+    }
+
+    int found = -1;
+    for (int k = 0; longopts[k].name != NULL; ++k) {
+        if (strncmp(longopts[k].name, name, len) != 0) continue;
+        if (found == -1) {
+            found = k;
+        } else if (longopts[k].has_arg != longopts[found].has_arg || longopts[k].flag != longopts[found].flag ||
+                   longopts[k].val != longopts[found].val) {
+            return -2;
+        }
+    }
+    return found;
+}
+
+// handles the long option in argv[cargs_optind], which starts with "--"
+static int cargs__getopt_long_one(int argc, char *const argv[], const cargs_option *longopts, int *longindex, bool colon)
+{
+    char *arg = argv[cargs_optind++];
+    char *name = arg + 2;
+    char *eq = strchr(name, '=');
+    size_t len = eq != NULL ? (size_t)(eq - name) : strlen(name);
+    bool report = cargs_opterr && !colon;
+
+    int k = cargs__getopt_find(longopts, name, len);
+    if (k < 0) {
+        if (report) fprintf(stderr, k == -2 ? "%s: option '%s' is ambiguous\n" : "%s: unrecognized option '%s'\n", argv[0], arg);
+        cargs_optopt = 0;
+        return '?';
+    }
+
+    const cargs_option *opt = &longopts[k];
+    if (opt->has_arg == CARGS_NO_ARGUMENT && eq != NULL) {
+        if (report) fprintf(stderr, "%s: option '--%s' doesn't allow an argument\n", argv[0], opt->name);
+        cargs_optopt = opt->val;
+        return '?';
+    }
+    if (eq != NULL) {
+        cargs_optarg = eq + 1;
+    } else if (opt->has_arg == CARGS_REQUIRED_ARGUMENT) {
+        if (cargs_optind >= argc) {
+            if (report) fprintf(stderr, "%s: option '--%s' requires an argument\n", argv[0], opt->name);
+            cargs_optopt = opt->val;
+            return colon ? ':' : '?';
+        }
+        cargs_optarg = argv[cargs_optind++];
+    }
+
+    if (longindex != NULL) *longindex = k;
+    if (opt->flag != NULL) {
+        *opt->flag = opt->val;
+        return 0;
+    }
+    return opt->val;
+}
+
+int cargs_getopt_long(int argc, char *const argv[], const char *optstring, const cargs_option *longopts, int *longindex)
+{
+    if (cargs_optind == 0) {
+        cargs_optind = 1;
+        cargs__getopt_state.next = NULL;
+        cargs__getopt_state.optstring = NULL;
+        cargs__getopt_state.longopts = NULL;
+    }
+    cargs__getopt_tables(optstring, longopts);
+
+    const char *spec = optstring;
+    bool in_order = *spec == '-';
+    if (*spec == '+' || *spec == '-') spec++;
+    bool colon = *spec == ':';
+    bool report = cargs_opterr && !colon;
+    cargs_optarg = NULL;
+
+    if (cargs__getopt_state.next == NULL) {
+        if (cargs_optind >= argc) return -1;
+        char *arg = argv[cargs_optind];
+        if (arg[0] != '-' || arg[1] == '\0') {
+            if (!in_order) return -1;
+            cargs_optarg = arg;
+            cargs_optind++;
+            return 1;
+        }
+        if (arg[1] == '-' && arg[2] == '\0') {
+            cargs_optind++;
+            return -1;
+        }
+        if (arg[1] == '-' && longopts != NULL) return cargs__getopt_long_one(argc, argv, longopts, longindex, colon);
+        cargs__getopt_state.next = arg + 1;
+    }
+
+    // the next short option of the cluster; the argument moves on once the cluster is used up
+    char *c = cargs__getopt_state.next++;
+    int kind = cargs__getopt_state.shorts[(unsigned char)*c];
+    bool last = c[1] == '\0';
+    if (last) {
+        cargs_optind++;
+        cargs__getopt_state.next = NULL;
+    }
+
+    if (kind == 0) {
+        if (report) fprintf(stderr, "%s: invalid option -- '%c'\n", argv[0], *c);
+        cargs_optopt = (unsigned char)*c;
+        return '?';
+    }
+    if (kind - 1 != CARGS_NO_ARGUMENT) {
+        if (!last) {
+            // -ovalue
+            cargs_optarg = c + 1;
+            cargs_optind++;
+            cargs__getopt_state.next = NULL;
+        } else if (kind - 1 == CARGS_REQUIRED_ARGUMENT) {
+            if (cargs_optind >= argc) {
+                if (report) fprintf(stderr, "%s: option requires an argument -- '%c'\n", argv[0], *c);
+                cargs_optopt = (unsigned char)*c;
+                return colon ? ':' : '?';
+            }
+            cargs_optarg = argv[cargs_optind++];
+        }
+    }
+    return (unsigned char)*c;
+}
+
+int cargs_getopt(int argc, char *const argv[], const char *optstring)
+{
+    return cargs_getopt_long(argc, argv, optstring, NULL, NULL);
 }
 
 #endif //CARGS_IMPLEMENTATION
@@ -0,0 +1,795 @@
+// cargs_gen: offline generator that turns a flag spec into a specialized single-header parser.
+//
+// The generated parser recognises flag names with a switch on the name length followed by a switch
+// on the most distinctive character and a single memcmp, and converts values with a per-flag switch
+// case instead of registering flags at runtime. It reports errors through the same cargs_error /
+// enum cargs_errors surface as cargs.h and uses cargs.h's converters, so the program still compiles
+// cargs.h with CARGS_IMPLEMENTATION in exactly one translation unit.
+//
+// Build and run:
+//   gcc cargs_gen.c -o cargs_gen
+//   ./cargs_gen spec.txt myflags > myflags.h
+//
+// Spec format, one entry per line ('#' starts a comment):
+//   <type> <name> <default> <description...>
+//   positional <name> mandatory|optional <description...>
+//   help <name>
+//   alias <alias> <name>
+// <type> is one of the cargs_<type> suffixes: bool char int8 uint8 int16 uint16 int32 uint32 int64
+// uint64 int size_t float double long_double string. <default> is a C literal copied verbatim
+// (e.g. true, 42, 0.5, 'x', "out.txt" or NULL). "help <name>" mirrors cargs_mark_help() and
+// "alias <alias> <name>" mirrors cargs_alias().
+//
+// The generated parser accepts the same spellings as cargs_parse(): values attached as --name=value or
+// -ovalue, boolean short flags clustered as -abc, --flag=false (or no, off, 0) for booleans, and aliases.
+
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GEN_MAX_LINE 4096
+
+enum gen_kind { GEN_BOOL, GEN_CHAR, GEN_SIGNED, GEN_UNSIGNED, GEN_FLOAT, GEN_STRING, GEN_POSITIONAL };
+
+struct gen_type {
+    const char *spec;    // name used in the spec
+    const char *ctype;   // C type of the generated field
+    enum gen_kind kind;
+    const char *min;     // range passed to the converter
+    const char *max;
+};
+
+static const struct gen_type gen_types[] = {
+    { "bool",        "bool",        GEN_BOOL,     NULL,        NULL       },
+    { "char",        "char",        GEN_CHAR,     NULL,        NULL       },
+    { "int8",        "int8_t",      GEN_SIGNED,   "INT8_MIN",  "INT8_MAX" },
+    { "uint8",       "uint8_t",     GEN_UNSIGNED, "0",         "UINT8_MAX" },
+    { "int16",       "int16_t",     GEN_SIGNED,   "INT16_MIN", "INT16_MAX" },
+    { "uint16",      "uint16_t",    GEN_UNSIGNED, "0",         "UINT16_MAX" },
+    { "int32",       "int32_t",     GEN_SIGNED,   "INT32_MIN", "INT32_MAX" },
+    { "uint32",      "uint32_t",    GEN_UNSIGNED, "0",         "UINT32_MAX" },
+    { "int64",       "int64_t",     GEN_SIGNED,   "INT64_MIN", "INT64_MAX" },
+    { "uint64",      "uint64_t",    GEN_UNSIGNED, "0",         "UINT64_MAX" },
+    { "int",         "int",         GEN_SIGNED,   "INT_MIN",   "INT_MAX" },
+    { "size_t",      "size_t",      GEN_UNSIGNED, "0",         "SIZE_MAX" },
+    { "float",       "float",       GEN_FLOAT,    "-FLT_MAX",  "FLT_MAX" },
+    { "double",      "double",      GEN_FLOAT,    "-DBL_MAX",  "DBL_MAX" },
+    { "long_double", "long double", GEN_FLOAT,    "-LDBL_MAX", "LDBL_MAX" },
+    { "string",      "char *",      GEN_STRING,   NULL,        NULL       },
+    { "positional",  "char *",      GEN_POSITIONAL, NULL,      NULL       },
+};
+
+struct gen_flag {
+    const struct gen_type *type;
+    char *name;
+    char *field;
+    char *def;       // C literal, or "mandatory"/"optional" for positionals
+    char *desc;
+    bool mandatory;
+    bool is_help;
+    char *alias;     // the last alias, for help output
+};
+
+// a name the matcher recognises: a flag's own or an alias of it
+struct gen_name {
+    const char *name;
+    size_t flag;
+};
+
+static struct gen_flag *gen_flags = NULL;
+static size_t gen_count = 0;
+static struct gen_name *gen_aliases = NULL;
+static size_t gen_nalias = 0;
+
+static void gen_die(const char *path, size_t line, const char *msg, const char *what)
+{
+    fprintf(stderr, "%s:%zu: %s%s%s\n", path, line, msg, what ? ": " : "", what ? what : "");
+    exit(1);
+}
+
+static char *gen_strndup(const char *s, size_t n)
+{
+    char *res = malloc(n + 1);
+    if (res == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    memcpy(res, s, n);
+    res[n] = '\0';
+    return res;
+}
+
+// reads the next whitespace separated word; quoted literals keep their quotes and may contain spaces
+static char *gen_word(char **cursor)
+{
+    char *s = *cursor;
+    while (isspace((unsigned char)*s)) s++;
+    if (*s == '\0') return NULL;
+
+    char *begin = s;
+    if (*s == '"' || *s == '\'') {
+        char quote = *s++;
+        while (*s != '\0' && *s != quote) {
+            if (*s == '\\' && s[1] != '\0') s++;
+            s++;
+        }
+        if (*s == quote) s++;
+    } else {
+        while (*s != '\0' && !isspace((unsigned char)*s)) s++;
+    }
+
+    *cursor = s;
+    return gen_strndup(begin, (size_t)(s - begin));
+}
+
+// derives a C identifier from a flag name: "--max-lines" -> "max_lines"
+static char *gen_field(const char *name)
+{
+    while (*name == '-') name++;
+    char *res = gen_strndup(name, strlen(name) + 1);
+    char *out = res;
+    if (isdigit((unsigned char)*name)) *out++ = '_';
+    for (; *name; ++name) {
+        *out++ = isalnum((unsigned char)*name) ? *name : '_';
+    }
+    *out = '\0';
+    return res;
+}
+
+static struct gen_flag *gen_find(const char *name)
+{
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (strcmp(gen_flags[i].name, name) == 0) return &gen_flags[i];
+    }
+    return NULL;
+}
+
+static bool gen_is_alias(const char *name)
+{
+    for (size_t a = 0; a < gen_nalias; ++a) {
+        if (strcmp(gen_aliases[a].name, name) == 0) return true;
+    }
+    return false;
+}
+
+static struct gen_flag *gen_find_field(const char *field)
+{
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (strcmp(gen_flags[i].field, field) == 0) return &gen_flags[i];
+    }
+    return NULL;
+}
+
+static void gen_read_spec(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        exit(1);
+    }
+
+    char buf[GEN_MAX_LINE];
+    size_t line = 0;
+    while (fgets(buf, sizeof(buf), f) != NULL) {
+        line++;
+        char *hash = strchr(buf, '#');
+        if (hash != NULL && (hash == buf || isspace((unsigned char)hash[-1]))) *hash = '\0';
+
+        char *cursor = buf;
+        char *kind = gen_word(&cursor);
+        if (kind == NULL) continue;
+
+        char *name = gen_word(&cursor);
+        if (name == NULL) gen_die(path, line, "missing flag name", NULL);
+
+        if (strcmp(kind, "help") == 0) {
+            struct gen_flag *flag = gen_find(name);
+            if (flag == NULL) gen_die(path, line, "help refers to an unknown flag", name);
+            if (flag->type->kind != GEN_BOOL) gen_die(path, line, "help flag must be a bool", name);
+            flag->is_help = true;
+            continue;
+        }
+
+        if (strcmp(kind, "alias") == 0) {
+            char *target = gen_word(&cursor);
+            if (target == NULL) gen_die(path, line, "missing flag name for alias", name);
+            struct gen_flag *flag = gen_find(target);
+            if (flag == NULL) gen_die(path, line, "alias refers to an unknown flag", target);
+            if (flag->type->kind == GEN_POSITIONAL) gen_die(path, line, "alias refers to a positional", target);
+            if (gen_find(name) != NULL || gen_is_alias(name)) gen_die(path, line, "duplicate flag name", name);
+            gen_aliases = realloc(gen_aliases, (gen_nalias + 1) * sizeof(*gen_aliases));
+            if (gen_aliases == NULL) gen_die(path, line, "out of memory", NULL);
+            gen_aliases[gen_nalias].name = name;
+            gen_aliases[gen_nalias++].flag = (size_t)(flag - gen_flags);
+            flag->alias = name;
+            free(target);
+            free(kind);
+            continue;
+        }
+
+        const struct gen_type *type = NULL;
+        for (size_t i = 0; i < sizeof(gen_types) / sizeof(gen_types[0]); ++i) {
+            if (strcmp(gen_types[i].spec, kind) == 0) type = &gen_types[i];
+        }
+        if (type == NULL) gen_die(path, line, "unknown type", kind);
+        if (gen_find(name) != NULL || gen_is_alias(name)) gen_die(path, line, "duplicate flag name", name);
+        // "-n" and "--n", or "--max-lines" and "--max_lines", would be two members of the same name
+        char *field = gen_field(name);
+        const struct gen_flag *clash = gen_find_field(field);
+        if (clash != NULL) {
+            char what[2 * GEN_MAX_LINE + 32];
+            snprintf(what, sizeof(what), "%s and %s both become \"%s\"", clash->name, name, field);
+            gen_die(path, line, "flag names map to the same field", what);
+        }
+
+        char *def = gen_word(&cursor);
+        if (def == NULL) gen_die(path, line, "missing default value", name);
+
+        while (isspace((unsigned char)*cursor)) cursor++;
+        size_t desc_len = strlen(cursor);
+        while (desc_len > 0 && isspace((unsigned char)cursor[desc_len - 1])) desc_len--;
+
+        gen_flags = realloc(gen_flags, (gen_count + 1) * sizeof(*gen_flags));
+        if (gen_flags == NULL) gen_die(path, line, "out of memory", NULL);
+
+        struct gen_flag *flag = &gen_flags[gen_count++];
+        memset(flag, 0, sizeof(*flag));
+        flag->type  = type;
+        flag->name  = name;
+        flag->field = field;
+        flag->def   = def;
+        flag->desc  = gen_strndup(cursor, desc_len);
+
+        if (type->kind == GEN_POSITIONAL) {
+            if (strcmp(def, "mandatory") != 0 && strcmp(def, "optional") != 0) {
+                gen_die(path, line, "positional must be mandatory or optional", name);
+            }
+            flag->mandatory = strcmp(def, "mandatory") == 0;
+        }
+        free(kind);
+    }
+    fclose(f);
+}
+
+// prints s as the contents of a C string literal
+static void gen_escaped(FILE *out, const char *s)
+{
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        fputc(*s, out);
+    }
+}
+
+// The help text is assembled as the contents of C string literals, then emitted one literal per line. It copies
+// the layout of cargs_log_options(): descriptions start in one column after the widest names (at most
+// GEN_HELP_NAMES), are wrapped at GEN_HELP_WIDTH and followed by the default. The width is fixed when the header
+// is generated, while cargs_log_options() follows the terminal.
+#define GEN_HELP_NAMES 24
+#define GEN_HELP_WIDTH 80
+
+struct gen_text {
+    char *buf;
+    size_t len;
+    size_t cap;
+};
+
+// appends n bytes of s; with escape set, as plain text that gets quotes and backslashes escaped
+static void gen_put(struct gen_text *t, const char *s, size_t n, bool escape)
+{
+    if (t->len + 2 * n + 1 > t->cap) {
+        t->cap = (t->len + 2 * n + 1) * 2;
+        t->buf = realloc(t->buf, t->cap);
+        if (t->buf == NULL) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        if (escape && (s[i] == '"' || s[i] == '\\')) t->buf[t->len++] = '\\';
+        t->buf[t->len++] = s[i];
+    }
+    t->buf[t->len] = '\0';
+}
+
+static void gen_pad(struct gen_text *t, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) gen_put(t, " ", 1, false);
+}
+
+// appends s from column col on, broken at spaces like cargs__text_wrap() does
+static void gen_wrap(struct gen_text *t, const char *s, size_t col)
+{
+    size_t room = GEN_HELP_WIDTH > col + 20 ? GEN_HELP_WIDTH - col : 20;
+    size_t n = strlen(s);
+    while (n > room) {
+        size_t cut = room;
+        while (cut > 0 && s[cut] != ' ') cut--;
+        if (cut == 0) {
+            cut = 1;
+            while (cut < n && s[cut] != ' ') cut++;
+        }
+        if (cut >= n) break;
+        gen_put(t, s, cut, true);
+        gen_put(t, "\n", 1, false);
+        while (cut < n && s[cut] == ' ') cut++;
+        s += cut;
+        n -= cut;
+        gen_pad(t, col);
+    }
+    gen_put(t, s, n, true);
+    gen_put(t, "\n", 1, false);
+}
+
+// appends a default literal the way cargs_log_options() would show it
+static void gen_default_text(struct gen_text *t, const struct gen_flag *flag)
+{
+    const char *def = flag->def;
+    size_t len = strlen(def);
+    if ((def[0] == '"' || def[0] == '\'') && len >= 2) {
+        def++;
+        len -= 2;
+    }
+    if (flag->type->kind == GEN_STRING && strcmp(flag->def, "NULL") == 0) {
+        def = "(NULL)";
+        len = strlen(def);
+    }
+    // the literal is escaped already, except for a quote in a character literal
+    gen_put(t, "Default: ", 9, false);
+    for (size_t i = 0; i < len; ++i) {
+        if (def[i] == '\\' && i + 1 < len) gen_put(t, &def[i++], 1, false);
+        else if (def[i] == '"') gen_put(t, "\\", 1, false);
+        gen_put(t, &def[i], 1, false);
+    }
+}
+
+static void gen_options_text(FILE *out, bool printdefault)
+{
+    size_t names = 0;
+    for (size_t i = 0; i < gen_count; ++i) {
+        const char *alias = gen_flags[i].alias;
+        size_t w = strlen(gen_flags[i].name) + (alias != NULL ? 2 + strlen(alias) : 0);
+        if (w > names) names = w;
+    }
+    size_t col = 4 + (names < GEN_HELP_NAMES ? names : GEN_HELP_NAMES) + 2;
+
+    struct gen_text t = { NULL, 0, 0 };
+    gen_put(&t, "", 0, false);
+    for (size_t i = 0; i < gen_count; ++i) {
+        const struct gen_flag *flag = &gen_flags[i];
+        size_t used = 4 + strlen(flag->name);
+        gen_pad(&t, 4);
+        gen_put(&t, flag->name, strlen(flag->name), true);
+        if (flag->alias != NULL) {
+            gen_put(&t, ", ", 2, false);
+            gen_put(&t, flag->alias, strlen(flag->alias), true);
+            used += 2 + strlen(flag->alias);
+        }
+        // names too wide for the column get a line of their own
+        if (used + 2 > col) {
+            gen_put(&t, "\n", 1, false);
+            used = 0;
+        }
+        gen_pad(&t, col - used);
+        gen_wrap(&t, flag->desc, col);
+        if (!printdefault) continue;
+        gen_pad(&t, col);
+        if (flag->type->kind == GEN_POSITIONAL) {
+            const char *kind = flag->mandatory ? "Mandatory" : "Optional";
+            gen_put(&t, kind, strlen(kind), false);
+        } else {
+            gen_default_text(&t, flag);
+        }
+        gen_put(&t, "\n", 1, false);
+    }
+
+    // one literal per line; "\n" only ends a line where the text has a newline, not an escaped one
+    const char *line = t.buf;
+    for (const char *c = t.buf; *c != '\0'; ++c) {
+        if (*c != '\n') continue;
+        fprintf(out, "        \"%.*s\\n\"\n", (int)(c - line), line);
+        line = c + 1;
+    }
+    if (gen_count == 0) fprintf(out, "        \"\"\n");
+    free(t.buf);
+}
+
+// emits the name matcher: switch on the length, then on the character that best separates the
+// names of that length, then a single memcmp to confirm. Aliases return the index of their flag.
+static void gen_matcher(FILE *out, const char *prefix)
+{
+    struct gen_name *names = malloc((gen_count + gen_nalias) * sizeof(*names) + 1);
+    if (names == NULL) {
+        fprintf(stderr, "out of memory\n");
+        exit(1);
+    }
+    size_t nnames = 0, max_len = 0;
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (gen_flags[i].type->kind == GEN_POSITIONAL) continue;
+        names[nnames].name = gen_flags[i].name;
+        names[nnames++].flag = i;
+    }
+    for (size_t a = 0; a < gen_nalias; ++a) names[nnames++] = gen_aliases[a];
+    for (size_t n = 0; n < nnames; ++n) {
+        size_t len = strlen(names[n].name);
+        if (len > max_len) max_len = len;
+    }
+
+    fprintf(out, "// returns the index of the flag called s[0..len), or -1\n");
+    fprintf(out, "static int %s__match(const char *s, size_t len)\n{\n", prefix);
+    fprintf(out, "    switch (len) {\n");
+
+    for (size_t len = 1; len <= max_len; ++len) {
+        size_t count = 0;
+        for (size_t n = 0; n < nnames; ++n) {
+            if (strlen(names[n].name) == len) count++;
+        }
+        if (count == 0) continue;
+
+        // pick the character position with the most distinct values among names of this length
+        size_t best_pos = 0, best_distinct = 0;
+        for (size_t pos = 0; pos < len; ++pos) {
+            bool seen[256] = { false };
+            size_t distinct = 0;
+            for (size_t n = 0; n < nnames; ++n) {
+                if (strlen(names[n].name) != len) continue;
+                unsigned char c = (unsigned char)names[n].name[pos];
+                if (!seen[c]) {
+                    seen[c] = true;
+                    distinct++;
+                }
+            }
+            if (distinct > best_distinct) {
+                best_distinct = distinct;
+                best_pos = pos;
+            }
+        }
+
+        fprintf(out, "        case %zu:\n", len);
+        fprintf(out, "            switch (s[%zu]) {\n", best_pos);
+        bool emitted[256] = { false };
+        for (size_t n = 0; n < nnames; ++n) {
+            if (strlen(names[n].name) != len) continue;
+            unsigned char c = (unsigned char)names[n].name[best_pos];
+            if (emitted[c]) continue;
+            emitted[c] = true;
+            if (isprint(c) && c != '\'' && c != '\\') {
+                fprintf(out, "                case '%c':\n", c);
+            } else {
+                fprintf(out, "                case %d:\n", (int)c);
+            }
+            for (size_t m = n; m < nnames; ++m) {
+                if (strlen(names[m].name) != len || (unsigned char)names[m].name[best_pos] != c) continue;
+                fprintf(out, "                    if (memcmp(s, \"");
+                gen_escaped(out, names[m].name);
+                fprintf(out, "\", %zu) == 0) return %zu;\n", len, names[m].flag);
+            }
+            fprintf(out, "                    break;\n");
+        }
+        fprintf(out, "            }\n");
+        fprintf(out, "            break;\n");
+    }
+
+    fprintf(out, "    }\n");
+    if (nnames == 0) fprintf(out, "    (void)s;\n");
+    fprintf(out, "    return -1;\n");
+    fprintf(out, "}\n\n");
+    free(names);
+}
+
+// emits the helpers for attached values and clusters, which resolve tokens the way cargs_parse() does
+static void gen_spellings(FILE *out, const char *prefix)
+{
+    bool has_bool = false;
+    fprintf(out, "// sets flag i to value if it is a boolean; returns whether it is\n");
+    fprintf(out, "static bool %s__set_bool(struct %s *out, int i, bool value)\n{\n", prefix, prefix);
+    fprintf(out, "    switch (i) {\n");
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (gen_flags[i].type->kind != GEN_BOOL) continue;
+        fprintf(out, "        case %zu: out->%s = value; return true;\n", i, gen_flags[i].field);
+        has_bool = true;
+    }
+    fprintf(out, "        default: break;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    (void)out;\n");
+    fprintf(out, "    (void)value;\n");
+    fprintf(out, "    return false;\n}\n\n");
+
+    fprintf(out, "// Resolves a token like -abc or -ovalue that is no flag name itself: leading boolean short flags are set, and\n");
+    fprintf(out, "// the first short flag that takes a value gets the rest of the token (*attached), or the next argument if\n");
+    fprintf(out, "// nothing is left. Returns that flag or the last boolean, or -1 if a character names no flag.\n");
+    fprintf(out, "static int %s__cluster(struct %s *out, const char *token, char **attached)\n{\n", prefix, prefix);
+    fprintf(out, "    char name[3] = { '-', 0, 0 };\n");
+    fprintf(out, "    for (const char *c = token + 1; *c != '\\0'; ++c) {\n");
+    fprintf(out, "        name[1] = *c;\n");
+    fprintf(out, "        int i = %s__match(name, 2);\n", prefix);
+    fprintf(out, "        if (i == -1 || c[1] == '\\0') return i;\n");
+    fprintf(out, "        if (!%s__set_bool(out, i, true)) {\n", prefix);
+    fprintf(out, "            *attached = (char *)(c + 1);\n");
+    fprintf(out, "            return i;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    return -1;\n}\n\n");
+
+    if (!has_bool) return;
+    fprintf(out, "// reads the value of --flag=value for a boolean; the words are those of cargs.h's config files\n");
+    fprintf(out, "static bool %s__bool_word(const char *value, bool *dst)\n{\n", prefix);
+    fprintf(out, "    static const char *const words[] = { \"false\", \"true\", \"no\", \"yes\", \"off\", \"on\", \"0\", \"1\" };\n");
+    fprintf(out, "    for (size_t w = 0; w < sizeof(words) / sizeof(words[0]); ++w) {\n");
+    fprintf(out, "        if (strcmp(value, words[w]) == 0) {\n");
+    fprintf(out, "            *dst = (w & 1) != 0;\n");
+    fprintf(out, "            return true;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    return false;\n}\n\n");
+}
+
+static void gen_value_case(FILE *out, const char *prefix, size_t index)
+{
+    const struct gen_flag *flag = &gen_flags[index];
+    const struct gen_type *type = flag->type;
+
+    fprintf(out, "            case %zu: {\n", index);
+    if (type->kind == GEN_BOOL) {
+        fprintf(out, "                bool value = true;\n");
+        fprintf(out, "                if (attached != NULL && !%s__bool_word(attached, &value)) {\n", prefix);
+        fprintf(out, "                    %s__set_error(CARGS_ERROR_INVALID_NUMBER, name, attached);\n", prefix);
+        fprintf(out, "                    return false;\n");
+        fprintf(out, "                }\n");
+        fprintf(out, "                out->%s = value;\n", flag->field);
+        fprintf(out, "            }\n            break;\n\n");
+        return;
+    }
+
+    fprintf(out, "                char *arg = attached;\n");
+    fprintf(out, "                if (arg == NULL) {\n");
+    fprintf(out, "                    if (argc == 0 || %s__is_flag(*argv)) {\n", prefix);
+    fprintf(out, "                        %s__set_error(CARGS_ERROR_NO_VALUE, name, NULL);\n", prefix);
+    fprintf(out, "                        return false;\n");
+    fprintf(out, "                    }\n");
+    fprintf(out, "                    arg = *argv++;\n");
+    fprintf(out, "                    argc--;\n");
+    fprintf(out, "                }\n");
+
+    switch (type->kind) {
+        case GEN_CHAR:
+            fprintf(out, "                if (arg[0] == '\\0' || arg[1] != '\\0') {\n");
+            fprintf(out, "                    %s__set_error(CARGS_ERROR_INVALID_NUMBER, name, arg);\n", prefix);
+            fprintf(out, "                    return false;\n");
+            fprintf(out, "                }\n");
+            fprintf(out, "                out->%s = arg[0];\n", flag->field);
+            break;
+
+        case GEN_SIGNED:
+        case GEN_UNSIGNED:
+        case GEN_FLOAT: {
+            const char *val_t = type->kind == GEN_SIGNED ? "int64_t" : type->kind == GEN_UNSIGNED ? "uint64_t" : type->ctype;
+            const char *conv  = type->kind == GEN_SIGNED ? "cargs_str2int" : type->kind == GEN_UNSIGNED ? "cargs_str2uint"
+                              : strcmp(type->ctype, "float") == 0 ? "cargs_str2flt"
+                              : strcmp(type->ctype, "double") == 0 ? "cargs_str2dbl" : "cargs_str2float";
+            fprintf(out, "                %s val;\n", val_t);
+            fprintf(out, "                enum cargs_errors res = %s(&val, arg, %s, %s);\n", conv, type->min, type->max);
+            fprintf(out, "                if (res != CARGS_ERROR_NONE) {\n");
+            fprintf(out, "                    %s__set_error(res, name, arg);\n", prefix);
+            fprintf(out, "                    return false;\n");
+            fprintf(out, "                }\n");
+            fprintf(out, "                out->%s = (%s)val;\n", flag->field, type->ctype);
+        }
+        break;
+
+        case GEN_STRING:
+            fprintf(out, "                out->%s = arg;\n", flag->field);
+            break;
+
+        case GEN_BOOL:
+        case GEN_POSITIONAL:
+        default:
+            break;
+    }
+    fprintf(out, "            }\n            break;\n\n");
+}
+
+static void gen_emit(FILE *out, const char *spec_path, const char *prefix)
+{
+    char *upper = gen_strndup(prefix, strlen(prefix));
+    for (char *c = upper; *c; ++c) *c = (char)toupper((unsigned char)*c);
+
+    size_t npositional = 0;
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (gen_flags[i].type->kind == GEN_POSITIONAL) npositional++;
+    }
+
+    // ---- header part ----
+    fprintf(out, "// Generated by cargs_gen from %s. Do not edit.\n", spec_path);
+    fprintf(out, "#ifndef %s_H\n#define %s_H\n\n", upper, upper);
+    fprintf(out, "#include \"cargs.h\"\n\n");
+
+    fprintf(out, "/// \\brief Values of all flags and positionals described in %s.\n", spec_path);
+    fprintf(out, "struct %s {\n", prefix);
+    for (size_t i = 0; i < gen_count; ++i) {
+        const struct gen_flag *flag = &gen_flags[i];
+        fprintf(out, "    %s%s%s; ///< %s: %s\n", flag->type->ctype,
+                flag->type->ctype[strlen(flag->type->ctype) - 1] == '*' ? "" : " ",
+                flag->field, flag->name, flag->desc);
+    }
+    if (gen_count == 0) fprintf(out, "    char unused;\n");
+    fprintf(out, "};\n\n");
+
+    fprintf(out, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    fprintf(out, "/// \\brief Fills out with the spec defaults, then parses argv into it.\n");
+    fprintf(out, "/// The first entry of the argv array (program name) is skipped.\n");
+    fprintf(out, "/// \\returns true if parsing was successful, false if an error occurred.\n");
+    fprintf(out, "bool %s_parse(struct %s *out, int argc, char **argv);\n\n", prefix, prefix);
+    fprintf(out, "/// \\brief Logs the current parsing error to the specified stream.\n");
+    fprintf(out, "void %s_log_error(FILE *stream);\n\n", prefix);
+    fprintf(out, "/// \\brief Returns a structure containing details about the last parsing error.\n");
+    fprintf(out, "cargs_error %s_get_error(void);\n\n", prefix);
+    fprintf(out, "/// \\brief Prints the flags, their descriptions, and default values.\n");
+    fprintf(out, "void %s_log_options(FILE *stream, bool printdefault);\n\n", prefix);
+    fprintf(out, "#ifdef __cplusplus\n}\n#endif\n\n");
+    fprintf(out, "#endif // %s_H\n\n", upper);
+
+    // ---- implementation part ----
+    fprintf(out, "#ifdef %s_IMPLEMENTATION\n\n", upper);
+    fprintf(out, "#include <float.h>\n#include <limits.h>\n#include <string.h>\n\n");
+    fprintf(out, "static cargs_error %s__err;\n\n", prefix);
+
+    fprintf(out, "static void %s__set_error(enum cargs_errors err, const char *flag, char *value)\n{\n", prefix);
+    fprintf(out, "    %s__err.error = err;\n", prefix);
+    fprintf(out, "    %s__err.flag = (char *)flag;\n", prefix);
+    fprintf(out, "    %s__err.value = value;\n}\n\n", prefix);
+
+    fprintf(out, "static int %s__is_flag(const char *arg)\n{\n", prefix);
+    fprintf(out, "    // bare \"-\" is a conventional stdin token, not a flag\n");
+    fprintf(out, "    return arg != NULL && arg[0] == '-' && arg[1] != '\\0';\n}\n\n");
+
+    fprintf(out, "// flag names by index, for errors about a token that held more than the name\n");
+    fprintf(out, "static const char *const %s__names[] = {\n", prefix);
+    for (size_t i = 0; i < gen_count; ++i) {
+        fprintf(out, "    \"");
+        gen_escaped(out, gen_flags[i].name);
+        fprintf(out, "\",\n");
+    }
+    if (gen_count == 0) fprintf(out, "    \"\",\n");
+    fprintf(out, "};\n\n");
+
+    gen_matcher(out, prefix);
+    gen_spellings(out, prefix);
+
+    fprintf(out, "// stores arg in the next free positional\n");
+    fprintf(out, "static bool %s__positional(struct %s *out, size_t *next, char *arg)\n{\n", prefix, prefix);
+    fprintf(out, "    switch ((*next)++) {\n");
+    size_t pos = 0;
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (gen_flags[i].type->kind != GEN_POSITIONAL) continue;
+        fprintf(out, "        case %zu: out->%s = arg; return true;\n", pos++, gen_flags[i].field);
+    }
+    fprintf(out, "        default: break;\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    (void)out;\n");
+    fprintf(out, "    %s__set_error(CARGS_ERROR_UNKNOWN, arg, NULL);\n", prefix);
+    fprintf(out, "    return false;\n}\n\n");
+
+    fprintf(out, "bool %s_parse(struct %s *out, int argc, char **argv)\n{\n", prefix, prefix);
+    fprintf(out, "    static const struct %s defaults = {\n", prefix);
+    for (size_t i = 0; i < gen_count; ++i) {
+        const struct gen_flag *flag = &gen_flags[i];
+        if (flag->type->kind == GEN_POSITIONAL) {
+            fprintf(out, "        NULL,\n");
+        } else if (flag->type->kind == GEN_STRING) {
+            fprintf(out, "        (char *)%s,\n", flag->def);
+        } else {
+            fprintf(out, "        %s,\n", flag->def);
+        }
+    }
+    if (gen_count == 0) fprintf(out, "        0,\n");
+    fprintf(out, "    };\n");
+    fprintf(out, "    *out = defaults;\n");
+    fprintf(out, "    size_t positionals = 0;\n\n");
+    fprintf(out, "    // Remove first entry which is the program's name\n");
+    fprintf(out, "    if (argc > 0) {\n        argc--;\n        argv++;\n    }\n\n");
+    fprintf(out, "    while (argc > 0) {\n");
+    fprintf(out, "        char *flag_name = *argv++;\n");
+    fprintf(out, "        argc--;\n\n");
+    fprintf(out, "        // \"--\" sentinel: treat all remaining args as positionals\n");
+    fprintf(out, "        if (strcmp(flag_name, \"--\") == 0) {\n");
+    fprintf(out, "            while (argc > 0) {\n");
+    fprintf(out, "                argc--;\n");
+    fprintf(out, "                if (!%s__positional(out, &positionals, *argv++)) return false;\n", prefix);
+    fprintf(out, "            }\n");
+    fprintf(out, "            break;\n");
+    fprintf(out, "        }\n\n");
+    fprintf(out, "        int index = %s__match(flag_name, strlen(flag_name));\n\n", prefix);
+    fprintf(out, "        // Otherwise a long flag may carry its value as --name=value and short flags may be written as -ovalue or\n");
+    fprintf(out, "        // clustered as -abc. The value points into the token; argv is not modified.\n");
+    fprintf(out, "        char *attached = NULL;\n");
+    fprintf(out, "        bool split = false;\n");
+    fprintf(out, "        if (index == -1 && flag_name[0] == '-' && flag_name[1] == '-') {\n");
+    fprintf(out, "            char *eq = strchr(flag_name + 2, '=');\n");
+    fprintf(out, "            if (eq != NULL) {\n");
+    fprintf(out, "                index = %s__match(flag_name, (size_t)(eq - flag_name));\n", prefix);
+    fprintf(out, "                attached = eq + 1;\n");
+    fprintf(out, "                split = true;\n");
+    fprintf(out, "            }\n");
+    fprintf(out, "        } else if (index == -1 && flag_name[0] == '-' && flag_name[1] != '\\0') {\n");
+    fprintf(out, "            index = %s__cluster(out, flag_name, &attached);\n", prefix);
+    fprintf(out, "            split = true;\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "        // errors name the flag as typed, unless the token held more than its name\n");
+    fprintf(out, "        const char *name = split && index != -1 ? %s__names[index] : flag_name;\n", prefix);
+    if (gen_count == npositional) fprintf(out, "        (void)name;\n");
+    fprintf(out, "\n");
+    fprintf(out, "        switch (index) {\n");
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (gen_flags[i].type->kind == GEN_POSITIONAL) continue;
+        gen_value_case(out, prefix, i);
+    }
+    fprintf(out, "            default: {\n");
+    fprintf(out, "                if (%s__is_flag(flag_name)) {\n", prefix);
+    fprintf(out, "                    %s__set_error(CARGS_ERROR_UNKNOWN, flag_name, NULL);\n", prefix);
+    fprintf(out, "                    return false;\n");
+    fprintf(out, "                }\n");
+    fprintf(out, "                if (!%s__positional(out, &positionals, flag_name)) return false;\n", prefix);
+    fprintf(out, "            }\n");
+    fprintf(out, "        }\n");
+    fprintf(out, "    }\n\n");
+
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (!gen_flags[i].is_help) continue;
+        fprintf(out, "    if (out->%s) return true;\n", gen_flags[i].field);
+    }
+
+    pos = 0;
+    for (size_t i = 0; i < gen_count; ++i) {
+        if (gen_flags[i].type->kind != GEN_POSITIONAL) continue;
+        if (gen_flags[i].mandatory) {
+            fprintf(out, "    if (positionals <= %zu) {\n", pos);
+            fprintf(out, "        %s__set_error(CARGS_ERROR_MISSING_POSITIONAL, \"", prefix);
+            gen_escaped(out, gen_flags[i].name);
+            fprintf(out, "\", NULL);\n");
+            fprintf(out, "        return false;\n    }\n");
+        }
+        pos++;
+    }
+    if (npositional == 0) fprintf(out, "    (void)positionals;\n");
+    fprintf(out, "    return true;\n}\n\n");
+
+    fprintf(out, "void %s_log_error(FILE *stream)\n{\n", prefix);
+    fprintf(out, "    cargs_print_error(stream, %s__err);\n}\n\n", prefix);
+
+    fprintf(out, "cargs_error %s_get_error(void)\n{\n", prefix);
+    fprintf(out, "    return %s__err;\n}\n\n", prefix);
+
+    fprintf(out, "void %s_log_options(FILE *stream, bool printdefault)\n{\n", prefix);
+    fprintf(out, "    static const char with_defaults[] =\n");
+    gen_options_text(out, true);
+    fprintf(out, "        ;\n");
+    fprintf(out, "    static const char without_defaults[] =\n");
+    gen_options_text(out, false);
+    fprintf(out, "        ;\n");
+    fprintf(out, "    fputs(printdefault ? with_defaults : without_defaults, stream);\n}\n\n");
+
+    fprintf(out, "#endif // %s_IMPLEMENTATION\n", upper);
+    free(upper);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <spec> <prefix>\n", argc > 0 ? argv[0] : "cargs_gen");
+        return 1;
+    }
+
+    for (const char *c = argv[2]; *c; ++c) {
+        if (!isalnum((unsigned char)*c) && *c != '_') {
+            fprintf(stderr, "prefix must be a C identifier: %s\n", argv[2]);
+            return 1;
+        }
+    }
+
+    gen_read_spec(argv[1]);
+    gen_emit(stdout, argv[1], argv[2]);
+
+    return 0;
+}
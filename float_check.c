@@ -0,0 +1,244 @@
+#define _POSIX_C_SOURCE 200809L
+#include <float.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CARGS_IMPLEMENTATION
+#include "cargs.h"
+
+// Checks that cargs_str2dbl() and cargs_str2flt() round every input of a generated corpus exactly like the C
+// library's strtod() and strtof(), which are correctly rounded on glibc and musl:
+//   gcc -O2 float_check.c -o float_check -lm
+//   ./float_check [cases per class, default 100000] [seed]
+// The corpus is reproducible from the seed. Each class targets one path of the converters:
+// - short decimals that take the fast path, and up to 19 digits with small exponents for the 128-bit path;
+// - random doubles and floats printed with 1 to 17 (9) significant digits;
+// - exact halfway points between neighbouring doubles and floats, printed in full, and one digit above them;
+// - mantissas of 20 to 800 random digits, which need the big-decimal fallback;
+// - subnormals, values around the overflow threshold, and hex floats;
+// - malformed strings, nan and inf, which must be rejected.
+// Mismatches are printed with both results; the exit status is 1 if there were any.
+
+#define CHECK_MAX_PRINTED 20
+
+static uint64_t seed = 0x9e3779b97f4a7c15u;
+static unsigned long checked, mismatches;
+
+// splitmix64
+static uint64_t check_rand(void)
+{
+    uint64_t z = (seed += 0x9e3779b97f4a7c15u);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+    return z ^ (z >> 31);
+}
+
+static double check_double_bits(uint64_t bits)
+{
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+static float check_float_bits(uint32_t bits)
+{
+    float f;
+    memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+static void check_format(char *buf, size_t size, enum cargs_errors res, double value)
+{
+    if (res == CARGS_ERROR_NONE) snprintf(buf, size, "%a", value);
+    else snprintf(buf, size, "error %d", (int)res);
+}
+
+// reports a mismatch unless the result equals the reference: the same error, or no error and the same bits
+static void check_compare(const char *what, const char *s, enum cargs_errors res, double value, enum cargs_errors ref, double ref_value, bool same)
+{
+    if (res == ref && (res != CARGS_ERROR_NONE || same)) return;
+    if (++mismatches > CHECK_MAX_PRINTED) return;
+    char want[64], got[64];
+    check_format(want, sizeof(want), ref, ref_value);
+    check_format(got, sizeof(got), res, value);
+    fprintf(stderr, "%s(\"%.80s%s\"): expected %s, got %s\n", what, s, strlen(s) > 80 ? "..." : "", want, got);
+}
+
+// the error for a result that is infinite in the target type: out of bounds if a long double holds the value,
+// otherwise overflow (underflow when negative), as when the converters narrowed from strtold()
+static enum cargs_errors check_range_error(const char *s, double ref)
+{
+    long double ld = strtold(s, NULL);
+    if (ld <= LDBL_MAX && ld >= -LDBL_MAX) return CARGS_ERROR_OUT_OF_BOUNDS;
+    return ref > 0 ? CARGS_ERROR_OVERFLOW : CARGS_ERROR_UNDERFLOW;
+}
+
+// compares both converters with the C library on s; results beyond the largest finite value must fail with the
+// error of check_range_error(), everything else must match bit for bit, including the sign of zero
+static void check(const char *s)
+{
+    double d = 0, ref_d = strtod(s, NULL);
+    enum cargs_errors res = cargs_str2dbl(&d, s, -DBL_MAX, DBL_MAX);
+    enum cargs_errors ref = ref_d > DBL_MAX || ref_d < -DBL_MAX ? check_range_error(s, ref_d) : CARGS_ERROR_NONE;
+    check_compare("cargs_str2dbl", s, res, d, ref, ref_d, memcmp(&d, &ref_d, sizeof(d)) == 0);
+
+    float f = 0, ref_f = strtof(s, NULL);
+    res = cargs_str2flt(&f, s, -FLT_MAX, FLT_MAX);
+    ref = ref_f > FLT_MAX || ref_f < -FLT_MAX ? check_range_error(s, ref_f) : CARGS_ERROR_NONE;
+    check_compare("cargs_str2flt", s, res, f, ref, ref_f, memcmp(&f, &ref_f, sizeof(f)) == 0);
+    checked++;
+}
+
+static void check_rejected(const char *s)
+{
+    double d;
+    float f;
+    if (cargs_str2dbl(&d, s, -DBL_MAX, DBL_MAX) == CARGS_ERROR_NONE || cargs_str2flt(&f, s, -FLT_MAX, FLT_MAX) == CARGS_ERROR_NONE) {
+        if (++mismatches <= CHECK_MAX_PRINTED) fprintf(stderr, "\"%s\": expected an error, got a value\n", s);
+    }
+    checked++;
+}
+
+// random finite doubles of every magnitude and sign
+static double check_random_double(void)
+{
+    double d;
+    do d = check_double_bits(check_rand());
+    while (d != d || d > DBL_MAX || d < -DBL_MAX);
+    return d;
+}
+
+static void check_short_decimals(unsigned long n)
+{
+    char buf[64];
+    for (unsigned long k = 0; k < n; ++k) {
+        uint64_t m = check_rand() % 10000000000000000000u;
+        int digits = 1 + (int)(check_rand() % 19);
+        uint64_t cut = 1;
+        for (int i = 0; i < digits && cut <= m / 10; ++i) cut *= 10;
+        int e = (int)(check_rand() % 61) - 30;
+        snprintf(buf, sizeof(buf), "%s%" PRIu64 "e%d", check_rand() & 1 ? "-" : "", m % cut, e);
+        check(buf);
+    }
+}
+
+static void check_printed(unsigned long n)
+{
+    char buf[64];
+    for (unsigned long k = 0; k < n; ++k) {
+        snprintf(buf, sizeof(buf), "%.*e", (int)(check_rand() % 17), check_random_double());
+        check(buf);
+        float f;
+        do f = check_float_bits((uint32_t)check_rand());
+        while (f != f || f > FLT_MAX || f < -FLT_MAX);
+        snprintf(buf, sizeof(buf), "%.*e", (int)(check_rand() % 9), (double)f);
+        check(buf);
+    }
+}
+
+// Prints x exactly, which glibc does for any precision, then the same digits followed by a 1, which lies just
+// above the halfway point and must round the other way on a tie-to-even.
+static void check_exact(const char *fmt, long double x)
+{
+    static char buf[1200];
+    snprintf(buf, sizeof(buf), fmt, x);
+    check(buf);
+    char *e = strchr(buf, 'e');
+    if (e == NULL) return;
+    char *end = e;
+    while (end[-1] == '0') end--;
+    if (end[-1] == '.') end++;
+    memmove(end + 1, e, strlen(e) + 1);
+    *end = '1';
+    check(buf);
+}
+
+static void check_halfway(unsigned long n)
+{
+    for (unsigned long k = 0; k < n; ++k) {
+        float f;
+        do f = check_float_bits((uint32_t)check_rand() & 0x7fffffffu);
+        while (f != f || f >= FLT_MAX);
+        // the midpoint of two floats is exact in a double
+        check_exact("%.120Le", ((long double)f + (long double)nextafterf(f, FLT_MAX)) / 2);
+#if LDBL_MANT_DIG > DBL_MANT_DIG
+        double d;
+        do d = check_double_bits(check_rand() & 0x7fffffffffffffffu);
+        while (d != d || d >= DBL_MAX);
+        // and that of two doubles in a long double of more than 53 bits; subnormal midpoints need ~770 digits
+        check_exact("%.800Le", ((long double)d + (long double)nextafter(d, DBL_MAX)) / 2);
+#endif
+    }
+}
+
+static void check_long_digits(unsigned long n)
+{
+    char buf[900];
+    for (unsigned long k = 0; k < n; ++k) {
+        int digits = 20 + (int)(check_rand() % 781);
+        char *p = buf;
+        *p++ = (char)('1' + check_rand() % 9);
+        *p++ = '.';
+        for (int i = 1; i < digits; ++i) *p++ = (char)('0' + check_rand() % 10);
+        snprintf(p, sizeof(buf) - (size_t)(p - buf), "e%d", (int)(check_rand() % 700) - 350);
+        check(buf);
+    }
+}
+
+static void check_edges(unsigned long n)
+{
+    char buf[64];
+    for (unsigned long k = 0; k < n; ++k) {
+        // subnormal doubles and floats, printed with enough digits to round trip or fewer
+        double d = check_double_bits(check_rand() & 0x800fffffffffffffu);
+        snprintf(buf, sizeof(buf), "%.*e", (int)(check_rand() % 18), d);
+        check(buf);
+        float f = check_float_bits((uint32_t)check_rand() & 0x807fffffu);
+        snprintf(buf, sizeof(buf), "%.*e", (int)(check_rand() % 10), (double)f);
+        check(buf);
+        // around the overflow thresholds and the smallest subnormals
+        long double big = (long double)DBL_MAX * (1 + ((long double)(check_rand() % 2001) - 1000) * 1e-16L);
+        snprintf(buf, sizeof(buf), "%.*Le", (int)(check_rand() % 18), big);
+        if (big <= LDBL_MAX) check(buf);
+        snprintf(buf, sizeof(buf), "%.*e", (int)(check_rand() % 10), FLT_MAX * (1 + ((double)(check_rand() % 2001) - 1000) * 1e-8));
+        check(buf);
+        snprintf(buf, sizeof(buf), "%.*e", (int)(check_rand() % 18), 4.9406564584124654e-324 * (double)(check_rand() % 8) / 4);
+        check(buf);
+        // hex floats
+        snprintf(buf, sizeof(buf), "%a", check_random_double());
+        check(buf);
+    }
+
+    static const char *const fixed[] = {
+        "0", "-0", "0.0", "0e999999", "1", "-1", ".5", "5.", "1e308", "1.8e308", "1.7976931348623157e308",
+        "1.7976931348623158e308", "1.7976931348623159e308", "-1.7976931348623159e308", "3.4028235e38",
+        "3.4028236e38", "3.4028237e38", "2.2250738585072011e-308", "2.2250738585072012e-308", "4.9e-324",
+        "2.4703282292062327e-324", "2.4703282292062328e-324", "1.401298464324817e-45", "7.006492321624085e-46",
+        "7.006492321624086e-46", "9007199254740993", "9007199254740992.5", "16777217", "1e-99999", "1e99999",
+        "0x1p-1074", "0x1p-1075", "0x1.0000000000001p0", "0x1.00000000000008p0", "0X1P+0", "1e39", "-1e39",
+        "1e309", "-1e309", "1e4000", "1e4932", "1.2e4932", "-1e5000", "0x1p1024", "0x1p16384",
+    };
+    for (size_t k = 0; k < sizeof(fixed) / sizeof(*fixed); ++k) check(fixed[k]);
+
+    static const char *const malformed[] = {
+        "", " 1", "1 ", "+", "-", ".", "e5", "1e", "1e+", "1.2.3", "0x", "0x1p", "1f", "--1", "nan", "-nan", "inf",
+        "-inf", "infinity", "NAN", "0x1.p", "1,5",
+    };
+    for (size_t k = 0; k < sizeof(malformed) / sizeof(*malformed); ++k) check_rejected(malformed[k]);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long n = argc > 1 ? strtoul(argv[1], NULL, 10) : 100000;
+    if (argc > 2) seed = strtoull(argv[2], NULL, 0);
+
+    check_short_decimals(n);
+    check_printed(n);
+    check_halfway(n);
+    check_long_digits(n / 10);
+    check_edges(n);
+
+    printf("%lu inputs, %lu mismatches\n", checked, mismatches);
+    return mismatches != 0;
+}